@@ -0,0 +1,155 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace ascii_graph {
+/* Work done by an Arena, to check how much reaches the heap */
+struct ArenaStats {
+        long allocations = 0;
+        long blocks = 0;
+        std::size_t bytes = 0;
+        std::size_t reserved = 0;
+};
+
+/**
+ * Arena
+ * Monotonic allocator handing out memory from a few large blocks.
+ *
+ * An allocation bumps a pointer within the current block, a new block of
+ * twice the size is taken from the heap once it is full. Memory is not
+ * freed one allocation at a time, only the latest allocation is given
+ * back. A growing vector takes its new storage before it frees the old
+ * one, so it copies into fresh memory and the old storage stays dead
+ * until the scope ends; reserve() the final size where it is known.
+ * Instead of freeing, a Scope rewinds the arena to where it was when the
+ * scope was entered, the blocks are kept and reused by the next scope. A
+ * loop of queries run in scopes therefore only hits the heap until the
+ * largest query has been seen once.
+ *
+ * Not thread safe, every thread needs its own arena.
+ */
+class Arena
+{
+public:
+        /* position of the arena, see rewind() */
+        struct Mark {
+                std::size_t block;
+                std::size_t used;
+        };
+        /* rewinds the arena to its position at construction */
+        class Scope
+        {
+        public:
+                explicit Scope(Arena& arena)
+                        : _arena(arena), _mark(arena.mark())
+                {
+                }
+                ~Scope() { _arena.rewind(_mark); }
+                Scope(const Scope&) = delete;
+                Scope& operator=(const Scope&) = delete;
+        private:
+                Arena& _arena;
+                Mark _mark;
+        };
+        static const std::size_t default_block_size = 1 << 16;
+
+        explicit Arena(std::size_t block_size = default_block_size)
+                : _block_size(block_size)
+        {
+        }
+        ~Arena() { release(); }
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+        void* allocate(std::size_t size, std::size_t alignment);
+        void deallocate(void* pointer, std::size_t size);
+        Mark mark() const { return Mark{ _block, _used }; }
+        void rewind(const Mark& position);
+        void release();
+        const ArenaStats& stats() const { return _stats; }
+private:
+        struct Block {
+                char* data;
+                std::size_t size;
+        };
+        std::vector<Block> _blocks;
+        /* current block and the bytes used of it */
+        std::size_t _block = 0;
+        std::size_t _used = 0;
+        std::size_t _block_size;
+        ArenaStats _stats;
+};
+
+/**
+ * ArenaAllocator
+ * Allocator for the standard containers drawing from an Arena, or from the
+ * heap like std::allocator when no arena is given.
+ */
+template <typename T>
+class ArenaAllocator
+{
+public:
+        typedef T value_type;
+
+        ArenaAllocator(Arena* arena = nullptr) : _arena(arena) {}
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) : _arena(other.arena())
+        {
+        }
+        T* allocate(std::size_t count)
+        {
+                if (!_arena)
+                        return static_cast<T*>(
+                                ::operator new(count * sizeof(T)));
+                return static_cast<T*>(
+                        _arena->allocate(count * sizeof(T), alignof(T)));
+        }
+        void deallocate(T* pointer, std::size_t count)
+        {
+                if (!_arena)
+                        ::operator delete(pointer);
+                else
+                        _arena->deallocate(pointer, count * sizeof(T));
+        }
+        Arena* arena() const { return _arena; }
+private:
+        Arena* _arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& one, const ArenaAllocator<U>& two)
+{
+        return one.arena() == two.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& one, const ArenaAllocator<U>& two)
+{
+        return one.arena() != two.arena();
+}
+
+/* vector placed in an arena */
+template <typename T>
+using ArenaVector = std::vector< T, ArenaAllocator<T> >;
+} /* namespace ascii_graph */
+
+#endif /* __ARENA_H__ */
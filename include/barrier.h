@@ -0,0 +1,58 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __BARRIER_H__
+#define __BARRIER_H__
+
+#include <condition_variable>
+#include <mutex>
+
+namespace ascii_graph {
+/**
+ * Barrier
+ * Block until `count` threads called wait(), reusable for every round of a
+ * level or phase synchronous search.
+ */
+class Barrier
+{
+public:
+        explicit Barrier(int count) : _count(count), _waiting(0),
+                                      _generation(0) {}
+        void wait()
+        {
+                std::unique_lock<std::mutex> lock(_mutex);
+                unsigned long generation = _generation;
+                if (++_waiting == _count) {
+                        _waiting = 0;
+                        _generation++;
+                        _condition.notify_all();
+                        return;
+                }
+                _condition.wait(lock, [&] {
+                        return generation != _generation;
+                });
+        }
+private:
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        int _count;
+        int _waiting;
+        unsigned long _generation;
+};
+} /* namespace ascii_graph */
+
+#endif /* __BARRIER_H__ */
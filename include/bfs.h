@@ -0,0 +1,129 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __BFS_H__
+#define __BFS_H__
+
+#include <cstdint>
+#include <vector>
+#include "arena.h"
+
+namespace ascii_graph {
+/**
+ * BfsEngine
+ * Direction-optimizing breadth first search (Beamer et al.).
+ *
+ * Small frontiers are expanded top-down from a queue of vertices, large
+ * frontiers bottom-up by letting every unvisited vertex look for a parent in
+ * a frontier bitmap. Visited vertices are tracked in a dense bitmap and the
+ * BFS tree in a parent array, so a search is O(V + E) and the path to any
+ * visited vertex is read off in O(length).
+ *
+ * `Adjacency` is CsrGraph or BitMatrix, `out` holds the arcs leaving a
+ * vertex and `in` the arcs entering it (the same object for undirected
+ * graphs). The working arrays are placed in `arena` if given.
+ */
+template <typename Adjacency>
+class BfsEngine
+{
+public:
+        BfsEngine(const Adjacency& out, const Adjacency& in,
+                  Arena* arena = nullptr);
+        void run(int source, int goal = -1);
+        bool visited(int vertex) const
+        {
+                return (_visited[vertex / 64] >> (vertex % 64)) & 1;
+        }
+        int parent(int vertex) const { return _parent[vertex]; }
+        /* parent of every vertex, -1 for the source and unvisited ones */
+        const ArenaVector<int>& parents() const { return _parent; }
+        std::vector<int> path(int goal) const;
+        /* switch to bottom-up once the frontier has more than 1/alpha of
+         * the unexplored arcs, back to top-down once it holds less than
+         * 1/beta of the vertices */
+        void set_alpha(int alpha) { _alpha = alpha; }
+        void set_beta(int beta) { _beta = beta; }
+        int top_down_steps() const { return _top_down_steps; }
+        int bottom_up_steps() const { return _bottom_up_steps; }
+private:
+        void mark(int vertex, int parent);
+        long top_down_step(long& arcs);
+        long bottom_up_step(long& arcs);
+        void frontier_to_bitmap();
+        void bitmap_to_frontier();
+        const Adjacency& _out;
+        const Adjacency& _in;
+        int _count;
+        int _alpha = 14;
+        int _beta = 24;
+        int _top_down_steps = 0;
+        int _bottom_up_steps = 0;
+        ArenaVector<uint64_t> _visited;
+        ArenaVector<uint64_t> _frontier_bits;
+        ArenaVector<uint64_t> _next_bits;
+        ArenaVector<int> _frontier;
+        ArenaVector<int> _next;
+        ArenaVector<int> _parent;
+};
+
+/**
+ * BidirectionalBfs
+ * Point to point search growing one frontier from the source along the
+ * outgoing arcs and one from the goal along the incoming arcs.
+ *
+ * Each step expands a complete level of the frontier with fewer arcs.
+ * The search stops after the first level in which the two searches meet,
+ * the shortest of the connections found in that level is the result. On
+ * graphs with a small diameter this touches a tiny fraction of the vertices
+ * a one sided search explores. The working arrays are placed in `arena`
+ * if given.
+ */
+template <typename Adjacency>
+class BidirectionalBfs
+{
+public:
+        BidirectionalBfs(const Adjacency& out, const Adjacency& in,
+                         Arena* arena = nullptr);
+        std::vector<int> run(int source, int goal);
+        /* vertices reached by both searches together during the last run */
+        long explored() const { return _explored; }
+private:
+        struct Side {
+                explicit Side(Arena* arena)
+                        : distance(arena), parent(arena), frontier(arena),
+                          next(arena), arcs(0)
+                {
+                }
+                ArenaVector<int> distance;
+                ArenaVector<int> parent;
+                ArenaVector<int> frontier;
+                ArenaVector<int> next;
+                long arcs;
+        };
+        template <typename Function>
+        void expand(const Adjacency& adjacency, Side& side, Side& other,
+                    Function on_meet);
+        const Adjacency& _out;
+        const Adjacency& _in;
+        int _count;
+        long _explored = 0;
+        Side _forward;
+        Side _backward;
+};
+} /* namespace ascii_graph */
+
+#endif /* __BFS_H__ */
@@ -0,0 +1,142 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __BIT_MATRIX_H__
+#define __BIT_MATRIX_H__
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "csr.h"
+#include "neighbor_range.h"
+
+namespace ascii_graph {
+/**
+ * AlignedAllocator
+ * Standard allocator returning memory aligned to `Alignment` bytes.
+ */
+template <typename T, std::size_t Alignment>
+class AlignedAllocator
+{
+public:
+        typedef T value_type;
+        template <typename U> struct rebind {
+                typedef AlignedAllocator<U, Alignment> other;
+        };
+        AlignedAllocator() {}
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+        T* allocate(std::size_t count)
+        {
+                void* memory = nullptr;
+                if (posix_memalign(&memory, Alignment, count * sizeof(T)))
+                        throw std::bad_alloc();
+                return static_cast<T*>(memory);
+        }
+        void deallocate(T* memory, std::size_t) { free(memory); }
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment>&) const
+        {
+                return true;
+        }
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, Alignment>&) const
+        {
+                return false;
+        }
+};
+
+/**
+ * BitMatrix
+ * Adjacency matrix with one bit per entry, meant for dense graphs.
+ *
+ * Every row holds 64 vertices per word and is padded to a multiple of
+ * 256 bits, so each row starts on a 32 byte boundary. Neighbor enumeration
+ * only touches set bits (count trailing zeros), and when compiled with AVX2
+ * all-zero blocks of 256 columns are skipped with a single test. The
+ * out-degrees are counted while the bits are set, a search expanding a
+ * frontier reads them instead of counting a whole row for every vertex.
+ */
+class BitMatrix
+{
+public:
+        static const int block_words = 4;
+
+        void freeze(CsrBuilder& builder);
+        void assign(const CsrGraph& csr);
+        void thaw(CsrBuilder& builder);
+        int vertices() const { return _vertices; }
+        int arcs() const { return _arcs; }
+        int words_per_row() const { return _stride; }
+        const uint64_t* row(int vertex) const
+        {
+                return _bits.data() + static_cast<std::size_t>(vertex) *
+                        _stride;
+        }
+        bool test(int from, int to) const
+        {
+                return (row(from)[to / 64] >> (to % 64)) & 1;
+        }
+        int degree(int vertex) const { return _degrees[vertex]; }
+        NeighborRange neighbors(int vertex) const
+        {
+                return NeighborRange(row(vertex), _stride);
+        }
+
+        /**
+         * for_each
+         * Call `function` with the index of every set bit in the row of
+         * `vertex`, in ascending order.
+         */
+        template <typename Function>
+        void for_each(int vertex, Function function) const
+        {
+                const uint64_t* bits = row(vertex);
+                for (int block = 0 ; block < _stride ; block += block_words) {
+#ifdef __AVX2__
+                        __m256i chunk = _mm256_load_si256(
+                                reinterpret_cast<const __m256i*>(bits + block));
+                        if (_mm256_testz_si256(chunk, chunk))
+                                continue;
+#endif
+                        for (int word = block ; word < block + block_words ;
+                             word++) {
+                                uint64_t value = bits[word];
+                                while (value) {
+                                        function(word * 64 +
+                                                 __builtin_ctzll(value));
+                                        value &= value - 1;
+                                }
+                        }
+                }
+        }
+private:
+        void reset(int vertices);
+        void set(int from, int to);
+        int _vertices = 0;
+        int _arcs = 0;
+        int _stride = 0;
+        std::vector< uint64_t, AlignedAllocator<uint64_t, 32> > _bits;
+        std::vector<int> _degrees;
+};
+} /* namespace ascii_graph */
+
+#endif /* __BIT_MATRIX_H__ */
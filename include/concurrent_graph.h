@@ -0,0 +1,142 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __CONCURRENT_GRAPH_H__
+#define __CONCURRENT_GRAPH_H__
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "csr.h"
+#include "epoch.h"
+#include "graph.h"
+#include "graph_view.h"
+#include "landmarks.h"
+#include "snapshot.h"
+#include "symbol_table.h"
+
+namespace ascii_graph {
+/**
+ * ConcurrentGraph
+ * Graph shared by threads answering queries and a thread changing it.
+ *
+ * The readers search an immutable version of the graph: the names, the
+ * CSR arrays and the landmark index as of one update. A reader pins the
+ * current version for as long as it needs it without taking a lock, see
+ * Reader. The writers change a private Graph one after the other and
+ * publish a copy of it as the next version with a single pointer swap.
+ * The versions the readers can no longer reach are freed by epoch based
+ * reclamation, once the last reader that could have loaded them left.
+ *
+ * Every update copies the whole graph, O(V + E), so changes should be
+ * batched into few updates.
+ */
+class ConcurrentGraph
+{
+        struct Version;
+public:
+        /* a consistent version of the graph, pinned while alive */
+        class Reader
+        {
+        public:
+                explicit Reader(const ConcurrentGraph& graph);
+                Reader(const Reader&) = delete;
+                Reader& operator=(const Reader&) = delete;
+                /* the update that published the version, 0 for none */
+                unsigned long version() const;
+                int vertices() const;
+                int vertex_index(const std::string& name) const;
+                std::string vertex_name(int index) const;
+                bool directed() const;
+                /* the BFS variants count hops, the others add up the
+                 * weights by a Dijkstra search that uses the landmark index
+                 * for Landmarks queries */
+                std::vector<std::string> get_shortest_path(
+                        const std::string& point_a,
+                        const std::string& point_b,
+                        PathAlgorithm algorithm = PathAlgorithm::Bfs) const;
+                double get_shortest_distance(
+                        const std::string& point_a,
+                        const std::string& point_b,
+                        PathAlgorithm algorithm =
+                                PathAlgorithm::Dijkstra) const;
+                GraphView view() const;
+        private:
+                int find(const std::string& name) const;
+                std::vector<int> search(int start, int goal,
+                                        PathAlgorithm algorithm) const;
+                EpochDomain::Guard _guard;
+                const Version* _version;
+        };
+
+        ConcurrentGraph();
+        ~ConcurrentGraph();
+        ConcurrentGraph(const ConcurrentGraph&) = delete;
+        ConcurrentGraph& operator=(const ConcurrentGraph&) = delete;
+        /* apply `change` to the graph and publish the result, updates of
+         * several threads run one after the other */
+        void update(const std::function<void(Graph&)>& change);
+        unsigned long version() const;
+        std::vector<std::string> get_shortest_path(
+                const std::string& point_a, const std::string& point_b,
+                PathAlgorithm algorithm = PathAlgorithm::Bfs) const
+        {
+                return Reader(*this).get_shortest_path(point_a, point_b,
+                                                       algorithm);
+        }
+        double get_shortest_distance(const std::string& point_a,
+                                     const std::string& point_b,
+                                     PathAlgorithm algorithm =
+                                         PathAlgorithm::Dijkstra) const
+        {
+                return Reader(*this).get_shortest_distance(point_a, point_b,
+                                                           algorithm);
+        }
+        /* versions waiting for their last readers */
+        std::size_t retired() const { return _epochs.pending(); }
+private:
+        /* arrays of a published graph, `in` is only used when directed */
+        struct Version {
+                SymbolTable names;
+                CsrGraph out;
+                CsrGraph in;
+                LandmarkIndex landmarks;
+                /* tombstones of the removed vertices */
+                std::vector<char> removed;
+                /* the mapping attached arrays of a loaded graph point to */
+                std::shared_ptr<Snapshot> snapshot;
+                unsigned long number;
+                bool directed;
+                bool weighted;
+                const CsrGraph& reverse() const
+                {
+                        return directed ? in : out;
+                }
+        };
+        void publish();
+        Graph _graph;
+        std::mutex _writer;
+        std::atomic<const Version*> _current;
+        unsigned long _updates = 0;
+        mutable EpochDomain _epochs;
+};
+} /* namespace ascii_graph */
+
+#endif /* __CONCURRENT_GRAPH_H__ */
@@ -0,0 +1,184 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __CSR_H__
+#define __CSR_H__
+
+#include <cstddef>
+#include <vector>
+#include "neighbor_range.h"
+
+namespace ascii_graph {
+/* An arc with its weight, as added in bulk */
+struct Arc {
+        int from;
+        int to;
+        float weight;
+};
+
+/**
+ * CsrBuilder
+ * Growable adjacency lists used while a graph is being loaded.
+ *
+ * Adding a vertex or an arc is amortized O(1). Once loading is done the
+ * lists are frozen into a CsrGraph, which stores the same arcs in two flat
+ * arrays. Weights are only stored once an arc with a weight other than 1
+ * is added, until then every arc weighs 1.
+ *
+ * Loaders that know their arcs in advance add them in bulk instead: bulk
+ * arcs go into one flat array, sized once with reserve(), and are only
+ * sorted into place by the freeze.
+ */
+class CsrBuilder
+{
+public:
+        int add_vertex();
+        int add_vertices(int count);
+        void add_arc(int from, int to);
+        void add_arc(int from, int to, float weight);
+        void add_arcs(const Arc* first, const Arc* last, bool symmetric);
+        void reserve(int vertices, std::size_t arcs);
+        /* removals only see the lists, the bulk arcs have to be frozen
+         * into them first */
+        bool has_bulk() const { return !_bulk.empty(); }
+        int remove_arc(int from, int to);
+        void clear_arcs(int vertex);
+        void remove_arcs_to(const std::vector<char>& removed);
+        void compact(const std::vector<int>& mapping, int count);
+        int vertices() const { return static_cast<int>(_lists.size()); }
+        /* arcs of `vertex` added one at a time, the bulk arcs aren't
+         * included */
+        const std::vector<int>& arcs(int vertex) const
+        {
+                return _lists[vertex];
+        }
+        bool weighted() const { return _weighted; }
+        /* weights of the arcs of `vertex`, only valid if weighted() */
+        const std::vector<float>& weights(int vertex) const
+        {
+                return _weights[vertex];
+        }
+        void clear()
+        {
+                _lists.clear();
+                _weights.clear();
+                std::vector<Arc>().swap(_bulk);
+                _weighted = false;
+        }
+private:
+        friend class CsrGraph;
+        void make_weighted();
+        std::vector< std::vector<int> > _lists;
+        std::vector< std::vector<float> > _weights;
+        std::vector<Arc> _bulk;
+        bool _weighted = false;
+};
+
+/**
+ * CsrGraph
+ * Compressed sparse row storage of a frozen adjacency structure.
+ *
+ * The arcs of vertex `v` are the sorted, duplicate free targets in
+ * `targets[offsets[v]] .. targets[offsets[v + 1] - 1]`, so the memory use
+ * is proportional to V + E and walking the neighbors of a vertex is
+ * proportional to its degree. Weighted graphs keep the weight of arc `a` in
+ * `weights[a]`, parallel to the targets. The arrays are either owned or
+ * attached from a mapped snapshot.
+ */
+class CsrGraph
+{
+public:
+        CsrGraph() { view(); }
+        CsrGraph(const CsrGraph& other);
+        CsrGraph& operator=(const CsrGraph& other);
+        void freeze(CsrBuilder& builder);
+        void thaw(CsrBuilder& builder);
+        void transpose(const CsrGraph& graph);
+        void attach(const int* offsets, const int* targets,
+                    const float* weights, int vertices);
+        int vertices() const { return _vertices; }
+        int arcs() const { return _vertices ? _offset_data[_vertices] : 0; }
+        const int* offsets() const { return _offset_data; }
+        const int* targets() const { return _target_data; }
+        bool weighted() const { return _weight_data != nullptr; }
+        /* null for an unweighted graph */
+        const float* weights() const { return _weight_data; }
+        /* weight of the arc at `adj`, a pointer into begin() .. end() */
+        float weight(const int* adj) const
+        {
+                return _weight_data ? _weight_data[adj - _target_data] : 1;
+        }
+        const int* begin(int vertex) const
+        {
+                return _target_data + _offset_data[vertex];
+        }
+        const int* end(int vertex) const
+        {
+                return _target_data + _offset_data[vertex + 1];
+        }
+        int degree(int vertex) const
+        {
+                return _offset_data[vertex + 1] - _offset_data[vertex];
+        }
+        NeighborRange neighbors(int vertex) const
+        {
+                return NeighborRange(begin(vertex), end(vertex));
+        }
+        bool has_arc(int from, int to) const;
+
+        /**
+         * for_each
+         * Call `function` with every target of an arc leaving `vertex`, in
+         * ascending order.
+         */
+        template <typename Function>
+        void for_each(int vertex, Function function) const
+        {
+                for (const int* adj = begin(vertex) ; adj != end(vertex) ;
+                     ++adj) {
+                        function(*adj);
+                }
+        }
+
+        /**
+         * for_each_weighted
+         * Call `function` with the target and the weight of every arc
+         * leaving `vertex`, in ascending order of the targets.
+         */
+        template <typename Function>
+        void for_each_weighted(int vertex, Function function) const
+        {
+                for (const int* adj = begin(vertex) ; adj != end(vertex) ;
+                     ++adj) {
+                        function(*adj, weight(adj));
+                }
+        }
+private:
+        void view();
+        std::vector<int> _offsets;
+        std::vector<int> _targets;
+        std::vector<float> _weights;
+        /* the arrays in use, either the vectors above or attached ones */
+        const int* _offset_data;
+        const int* _target_data;
+        const float* _weight_data;
+        int _vertices;
+        bool _attached = false;
+};
+} /* namespace ascii_graph */
+
+#endif /* __CSR_H__ */
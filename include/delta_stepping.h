@@ -0,0 +1,91 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __DELTA_STEPPING_H__
+#define __DELTA_STEPPING_H__
+
+#include <atomic>
+#include <limits>
+#include <vector>
+#include "csr.h"
+
+namespace ascii_graph {
+/**
+ * DeltaStepping
+ * Parallel single source shortest paths by arc weight, weights must not be
+ * negative.
+ *
+ * Tentative distances are sorted into buckets of width delta. The vertices
+ * of the lowest bucket relax their light arcs (weight <= delta) in
+ * parallel until the bucket stays empty, then the heavy arcs of all
+ * vertices removed from it are relaxed once. The relaxations of a phase
+ * are collected in thread local request buffers and applied by one thread
+ * between two barriers, so the distances are never written concurrently.
+ *
+ * A delta of 0 picks the mean arc weight.
+ */
+class DeltaStepping
+{
+public:
+        DeltaStepping(const CsrGraph& out, int threads);
+        void set_delta(double delta) { _delta = delta; }
+        double delta() const { return _delta; }
+        void run(int source, int goal = -1);
+        bool reached(int vertex) const
+        {
+                return _distance[vertex] !=
+                        std::numeric_limits<double>::infinity();
+        }
+        double distance(int vertex) const { return _distance[vertex]; }
+        int parent(int vertex) const { return _parent[vertex]; }
+        std::vector<int> path(int goal) const;
+        int threads() const { return _threads; }
+private:
+        struct Request {
+                int vertex;
+                int parent;
+                double distance;
+        };
+        void relax(int worker);
+        void apply();
+        bool prepare(int goal);
+        std::size_t bucket(double distance) const
+        {
+                return static_cast<std::size_t>(distance / _delta);
+        }
+        const CsrGraph& _out;
+        int _count;
+        int _threads;
+        double _delta = 0;
+        std::vector<double> _distance;
+        std::vector<int> _parent;
+        std::vector< std::vector<int> > _buckets;
+        std::size_t _current;
+        /* vertices of the phase and the kind of arcs they relax */
+        std::vector<int> _frontier;
+        bool _light;
+        std::atomic<long> _next_chunk;
+        /* removed from the current bucket, heavy arcs still to relax */
+        std::vector<int> _settled;
+        std::vector<std::size_t> _settled_in;
+        /* distance at which the light arcs of a vertex were relaxed */
+        std::vector<double> _expanded;
+        std::vector< std::vector<Request> > _requests;
+};
+} /* namespace ascii_graph */
+
+#endif /* __DELTA_STEPPING_H__ */
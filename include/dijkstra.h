@@ -0,0 +1,97 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __DIJKSTRA_H__
+#define __DIJKSTRA_H__
+
+#include <limits>
+#include <vector>
+#include "csr.h"
+
+namespace ascii_graph {
+/**
+ * Potential
+ * Lower bound of the distance left from a vertex to the goal of a search,
+ * infinity when the goal can't be reached from it. The bound has to be
+ * consistent: it may not drop by more than the weight of an arc along any
+ * arc.
+ */
+class Potential
+{
+public:
+        virtual ~Potential() {}
+        virtual double bound(int vertex, int goal) const = 0;
+};
+
+/**
+ * Dijkstra
+ * Single source shortest paths by arc weight, weights must not be negative.
+ *
+ * The open vertices are kept in a 4-ary heap with a position index, so a
+ * shorter distance found for a queued vertex moves its entry up instead of
+ * adding a second one. The wider heap is half as deep as a binary one and
+ * the children of an entry share a cache line.
+ *
+ * Given a Potential, the search turns into A*: the heap is ordered by the
+ * distance plus the bound to the goal, so the search heads towards the goal
+ * and vertices that can't reach it are never queued. The arrays are kept
+ * between runs and only the entries touched by the last run are reset, so
+ * a short search doesn't pay for the size of the graph.
+ */
+class Dijkstra
+{
+public:
+        static const int arity = 4;
+
+        explicit Dijkstra(const CsrGraph& out);
+        void run(int source, int goal = -1,
+                 const Potential* potential = nullptr);
+        bool reached(int vertex) const
+        {
+                return _distance[vertex] !=
+                        std::numeric_limits<double>::infinity();
+        }
+        double distance(int vertex) const { return _distance[vertex]; }
+        int parent(int vertex) const { return _parent[vertex]; }
+        std::vector<int> path(int goal) const;
+        /* vertices taken from the heap by the last run */
+        int settled() const { return _settled; }
+private:
+        struct Entry {
+                double distance;
+                int vertex;
+        };
+        void reset();
+        void push(int vertex, double key);
+        int pop();
+        void sift_up(std::size_t index);
+        void sift_down(std::size_t index);
+        void place(std::size_t index, const Entry& entry);
+        const CsrGraph& _out;
+        int _count;
+        std::vector<double> _distance;
+        std::vector<int> _parent;
+        std::vector<Entry> _heap;
+        /* index of a vertex in the heap, -1 when it isn't queued */
+        std::vector<int> _position;
+        /* vertices whose distance was set by the last run */
+        std::vector<int> _touched;
+        int _settled = 0;
+};
+} /* namespace ascii_graph */
+
+#endif /* __DIJKSTRA_H__ */
@@ -0,0 +1,128 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __DOT_LEXER_H__
+#define __DOT_LEXER_H__
+
+#include <cstddef>
+
+namespace ascii_graph {
+enum class TokenType {
+        Identifier,
+        LeftBrace,
+        RightBrace,
+        LeftBracket,
+        RightBracket,
+        Semicolon,
+        Comma,
+        Equals,
+        Colon,
+        UndirectedEdge,
+        DirectedEdge,
+        End,
+        Error,
+};
+
+/**
+ * Token
+ * A token of the DOT language, `text` points into the lexed buffer.
+ *
+ * For quoted strings `text` is the content between the quotes (escape
+ * sequences are kept as they are), for HTML strings the content between the
+ * outer angle brackets.
+ */
+struct Token {
+        TokenType type;
+        const char* text;
+        std::size_t length;
+        bool quoted;
+        int line;
+};
+
+/**
+ * DotLexer
+ * Split a buffer holding DOT source into tokens in a single pass.
+ *
+ * Whitespace, C and C++ style comments and lines starting with '#' are
+ * skipped. The lexer never copies or allocates, the buffer has to outlive
+ * the tokens.
+ */
+class DotLexer
+{
+public:
+        void reset(const char* begin, const char* end, int line = 1,
+                   bool line_start = true)
+        {
+                _cursor = begin;
+                _end = end;
+                _line = line;
+                _line_start = line_start;
+        }
+        Token next();
+        int line() const { return _line; }
+private:
+        void skip_ignored();
+        Token make(TokenType type, const char* text, std::size_t length);
+        Token identifier();
+        Token numeral();
+        Token quoted_string();
+        Token html_string();
+        const char* _cursor = nullptr;
+        const char* _end = nullptr;
+        int _line = 1;
+        bool _line_start = true;
+};
+
+/**
+ * StatementSplitter
+ * Find the places in a stream of DOT source where it can be cut between two
+ * top level statements, without tokenizing it.
+ *
+ * Quoted strings, HTML strings, comments and the nesting of braces and
+ * brackets are tracked across calls, so the stream can be fed in arbitrary
+ * chunks. Safe cuts are behind the '{' opening the graph body and behind
+ * every ';' on the top level of the body, outside of attribute lists,
+ * which may separate their attributes by ';' as well.
+ */
+class StatementSplitter
+{
+public:
+        std::size_t scan(const char* buffer, std::size_t size);
+        void consumed(std::size_t count);
+        void reset() { *this = StatementSplitter(); }
+private:
+        enum class State {
+                Code,
+                Quoted,
+                Html,
+                LineComment,
+                BlockComment,
+        };
+        State _state = State::Code;
+        std::size_t _position = 0;
+        std::size_t _boundary = 0;
+        int _depth = 0;
+        int _bracket_depth = 0;
+        int _html_depth = 0;
+        char _previous = '\n';
+        bool _line_start = true;
+};
+
+bool token_is_keyword(const Token& token, const char* keyword);
+} /* namespace ascii_graph */
+
+#endif /* __DOT_LEXER_H__ */
@@ -0,0 +1,89 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __EPOCH_H__
+#define __EPOCH_H__
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ascii_graph {
+/**
+ * EpochDomain
+ * Epoch based reclamation of objects that readers may still use after a
+ * writer unpublished them.
+ *
+ * A reader announces the global epoch in a slot of its own before it loads
+ * a shared pointer and clears the slot when it is done, neither takes a
+ * lock. A writer swaps the pointer first and then retires the old object,
+ * which stamps it with the epoch and advances the epoch. Every reader that
+ * loaded the old pointer announced an epoch up to the stamp before the
+ * swap, so the object is freed once no slot holds such an epoch.
+ */
+class EpochDomain
+{
+public:
+        /* readers at the same time, more wait for a free slot */
+        static const int slot_count = 128;
+        /* holds a slot from construction until destruction */
+        class Guard
+        {
+        public:
+                explicit Guard(EpochDomain& domain)
+                        : _domain(domain), _slot(domain.enter())
+                {
+                }
+                ~Guard() { _domain.leave(_slot); }
+                Guard(const Guard&) = delete;
+                Guard& operator=(const Guard&) = delete;
+        private:
+                EpochDomain& _domain;
+                int _slot;
+        };
+
+        EpochDomain();
+        /* frees all retired objects, no reader may be left */
+        ~EpochDomain();
+        EpochDomain(const EpochDomain&) = delete;
+        EpochDomain& operator=(const EpochDomain&) = delete;
+        int enter();
+        void leave(int slot);
+        /* call `reclaim` once no reader can use the object anymore */
+        void retire(std::function<void()> reclaim);
+        /* run the reclaims that are safe by now */
+        void collect();
+        /* retired objects that weren't freed yet */
+        std::size_t pending();
+private:
+        /* a slot per cache line, readers don't share lines */
+        struct Slot {
+                std::atomic<unsigned long> epoch;
+                char padding[64 - sizeof(std::atomic<unsigned long>)];
+        };
+        Slot _slots[slot_count];
+        std::atomic<unsigned long> _epoch;
+        std::mutex _retired_lock;
+        std::vector< std::pair<unsigned long, std::function<void()> > >
+                _retired;
+};
+} /* namespace ascii_graph */
+
+#endif /* __EPOCH_H__ */
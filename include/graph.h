@@ -18,23 +18,289 @@
 #ifndef __GRAPH_H__
 #define __GRAPH_H__
 
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
+#include "arena.h"
+#include "csr.h"
+#include "bit_matrix.h"
+#include "dijkstra.h"
+#include "graph_view.h"
+#include "output_sink.h"
+#include "landmarks.h"
+#include "path_cache.h"
+#include "print_coordinates.h"
+#include "snapshot.h"
+#include "symbol_table.h"
 
 namespace ascii_graph {
+/* Layout used for the adjacency structure once the graph is frozen */
+enum class StorageMode {
+        Csr,
+        BitMatrix,
+};
+
+/* Search used to answer shortest path queries, the BFS variants count
+ * hops and Dijkstra, DeltaStepping and Landmarks add up arc weights.
+ * Landmarks is an A* search guided by the landmark index, see
+ * build_landmarks(), and a plain Dijkstra without one. */
+enum class PathAlgorithm {
+        Bfs,
+        ParallelBfs,
+        BidirectionalBfs,
+        Dijkstra,
+        DeltaStepping,
+        Landmarks,
+};
+
+/* Layout of print_matrix(): the full grid of 0 and 1, one line per edge,
+ * the Matrix Market coordinate format, or the lengths of the runs of 0
+ * and 1 in every row. All but the grid grow with the arcs, not V^2. */
+enum class MatrixFormat {
+        Dense,
+        EdgeList,
+        MatrixMarket,
+        RunLength,
+};
+
+/* Change of a mutation log, see Graph::apply(). The vertices are named,
+ * so that a log stays valid when the graph is compacted. Added edges
+ * create missing vertices, `to`, `weight` and `directed` are only read by
+ * the edge changes. */
+struct Mutation {
+        enum class Kind {
+                AddVertex,
+                RemoveVertex,
+                AddEdge,
+                RemoveEdge,
+        };
+        Kind kind;
+        std::string from;
+        std::string to;
+        float weight;
+        bool directed;
+};
+
 class Graph
 {
 public:
-        void create_vertex(char value);
-        int link_two_vertices_undirected(int vertex_one, int vertex_two);
+        int create_vertex(const char* name, std::size_t length);
+        int create_vertex(const std::string& name)
+        {
+                return create_vertex(name.data(), name.size());
+        }
+        int create_vertex(char value)
+        {
+                return create_vertex(std::string(1, value));
+        }
+        int link_two_vertices_undirected(int vertex_one, int vertex_two,
+                                         float weight = 1);
+        int link_two_vertices_directed(int from, int to, float weight = 1);
+        /* bulk loading, the totals passed to reserve() avoid reallocations
+         * and the edges are only sorted into place by freeze() */
+        void reserve(int vertices, std::size_t edges, bool directed = false);
+        std::vector<int> add_vertices(const std::vector<std::string>& names);
+        int add_edges(const std::vector<Arc>& edges, bool directed = false);
+        /* A removed vertex keeps its index as a tombstone without arcs and
+         * its name isn't found anymore, until compact() renumbers the
+         * vertices that are left. Creating it again revives the index. */
+        int remove_edge(int vertex_one, int vertex_two,
+                        bool directed = false);
+        int remove_vertex(int vertex);
+        bool removed(int vertex) const
+        {
+                return vertex >= 0 &&
+                        vertex < static_cast<int>(_removed.size()) &&
+                        _removed[vertex];
+        }
+        int removed_vertices() const { return _removed_count; }
+        std::vector<int> compact();
+        /* apply a mutation log, compacting the graph afterwards once the
+         * given share of the vertices is removed, 0 never compacts */
+        int apply(const std::vector<Mutation>& batch);
+        void set_compaction_ratio(double ratio) { _compaction_ratio = ratio; }
+        /* true once any directed link was added */
+        bool directed() const { return _directed; }
+        /* true once any link with a weight other than 1 was added */
+        bool weighted() const { return _weighted; }
+        /* bumped by every change that can alter a query result */
+        unsigned long version() const { return _version; }
+        /* the drawings go to std::cout unless a sink is given */
         void print_graph();
-        void print_matrix();
-        std::vector<char> get_shortest_path(char point_a, char point_b);
-        bool empty() { return _vertices.empty(); }
+        void print_graph(OutputSink& sink);
+        /* the part of the drawing within `viewport`, the layout of the
+         * drawing is kept for paging until the graph is modified */
+        void print_graph(const Viewport& viewport);
+        void print_graph(OutputSink& sink, const Viewport& viewport);
+        /* drawing of the vertices at most `radius` arcs away from
+         * `center` in either direction and the arcs between them */
+        bool print_neighborhood(const std::string& center, int radius);
+        bool print_neighborhood(OutputSink& sink, const std::string& center,
+                                int radius);
+        /* options of the drawings, see Layout */
+        void set_layout(const Layout& layout)
+        {
+                _layout = layout;
+                _printer.reset();
+        }
+        void print_matrix(MatrixFormat format = MatrixFormat::Dense);
+        void print_matrix(OutputSink& sink,
+                          MatrixFormat format = MatrixFormat::Dense);
+        std::vector<std::string> get_shortest_path(
+                const std::string& point_a, const std::string& point_b,
+                PathAlgorithm algorithm = PathAlgorithm::Bfs);
+        std::vector<char> get_shortest_path(char point_a, char point_b,
+                                            PathAlgorithm algorithm =
+                                                PathAlgorithm::Bfs);
+        double get_shortest_distance(const std::string& point_a,
+                                     const std::string& point_b,
+                                     PathAlgorithm algorithm =
+                                         PathAlgorithm::Dijkstra);
+        std::vector< std::vector<std::string> > get_shortest_paths(
+                const std::vector< std::pair<std::string, std::string> >&
+                        queries);
+        std::vector< std::vector<char> > get_shortest_paths(
+                const std::vector< std::pair<char, char> >& queries);
+        std::vector<int> bfs_levels(const std::string& source);
+        std::vector<int> bfs_levels(char source)
+        {
+                return bfs_levels(std::string(1, source));
+        }
+        std::vector< std::vector<int> > distance_matrix(
+                const std::vector<std::string>& sources);
+        std::vector< std::vector<int> > distance_matrix(
+                const std::vector<char>& sources);
+        /* shortest paths and BFS trees kept for repeated queries */
+        void set_cache_capacity(std::size_t paths, std::size_t trees)
+        {
+                _cache.set_capacity(paths, trees);
+        }
+        const CacheStats& cache_stats() const { return _cache.stats(); }
+        /* arena holding the working arrays of the searches, an own one
+         * unless one shared by a whole session is set */
+        void set_arena(Arena* arena) { _arena = arena; }
+        const ArenaStats& arena_stats() const
+        {
+                return _arena ? _arena->stats() : _scratch.stats();
+        }
+        /* threads used by the parallel searches, 0 for all cores. Every
+         * query starts and joins its own threads, some tens of microseconds
+         * per thread, so small graphs are searched faster on one thread */
+        void set_threads(int threads) { _threads = threads; }
+        bool empty() { return _names.size() == _removed_count; }
+        /* the removed vertices are counted until compacted */
+        int vertices() const { return _names.size(); }
+        int vertex_index(const std::string& name) const
+        {
+                return find_vertex(name);
+        }
+        std::string vertex_name(int index) const
+        {
+                return _names.name(index);
+        }
+        /* read in place, valid until the graph is modified */
+        NeighborRange neighbors(int vertex);
+        GraphView view();
+        void freeze();
+        bool save_snapshot(const std::string& path);
+        bool load_snapshot(const std::string& path);
+        bool build_landmarks(int count = LandmarkIndex::default_count);
+        /* true while a landmark index matches the graph */
+        bool has_landmarks() const { return !_landmarks.empty(); }
+        void set_storage(StorageMode mode);
+        StorageMode storage() { return _storage; }
 private:
-        std::vector<int> adjacent_vertices(int vertex);
+        /* publishes copies of the frozen arrays */
+        friend class ConcurrentGraph;
+        int find_vertex(const char* name, std::size_t length) const
+        {
+                int index = _names.find(name, length);
+                return removed(index) ? -1 : index;
+        }
+        int find_vertex(const std::string& name) const
+        {
+                return find_vertex(name.data(), name.size());
+        }
+        void unpack();
+        int unlink(int vertex_one, int vertex_two, bool directed);
+        void drop_vertex(int vertex);
+        void revive(int vertex);
+        void purge();
+        std::vector<int> live_vertices();
+        void induced(const std::vector<int>& vertices, Graph& subgraph);
+        std::vector<int> shortest_path(int start_index, int goal_index,
+                                       PathAlgorithm algorithm);
+        std::vector<int> search(int start_index, int goal_index,
+                                PathAlgorithm algorithm);
+        std::vector< std::vector<int> > shortest_paths(
+                const std::vector< std::pair<int, int> >& queries);
+        std::vector< std::vector<int> > distances(
+                const std::vector<int>& sources);
         std::vector<int> breadth_first_search(int start_index, int goal_index);
-        std::vector<char> _vertices;
-        std::vector< std::vector<int> > _adj_matrix;
+        std::vector<int> bidirectional_search(int start_index,
+                                              int goal_index);
+        std::vector<int> parallel_search(int start_index, int goal_index,
+                                         std::vector<int>* levels);
+        std::vector<int> weighted_search(int start_index, int goal_index,
+                                         bool parallel);
+        std::vector<int> landmark_search(int start_index, int goal_index);
+        double path_length(const std::vector<int>& path);
+        int name_width();
+        void write_name(OutputSink& sink, int vertex);
+        template <typename Function>
+        void for_each_arc(int vertex, Function function);
+        void print_dense(OutputSink& sink);
+        void print_edge_list(OutputSink& sink);
+        void print_matrix_market(OutputSink& sink);
+        void print_run_lengths(OutputSink& sink);
+        PrintCoordinates& printer();
+        void thaw();
+        Arena& arena() { return _arena ? *_arena : _scratch; }
+        /* arcs entering every vertex, the out arcs of an undirected graph */
+        const CsrGraph& csr_in() const
+        {
+                return _directed ? _csr_in : _csr;
+        }
+        const BitMatrix& bit_matrix_in() const
+        {
+                return _directed ? _bit_matrix_in : _bit_matrix;
+        }
+        /* interned vertex names, the id of a name is its vertex index */
+        SymbolTable _names;
+        /* arcs leaving every vertex: adjacency lists while loading, CSR
+         * arrays or bits once frozen. Directed graphs keep the reverse
+         * arcs next to them, built when frozen. */
+        CsrBuilder _builder;
+        CsrGraph _csr;
+        CsrGraph _csr_in;
+        BitMatrix _bit_matrix;
+        BitMatrix _bit_matrix_in;
+        /* mapping used by the names and the CSR arrays of a loaded graph */
+        std::shared_ptr<Snapshot> _snapshot;
+        /* dropped with every modification, like the frozen arrays */
+        LandmarkIndex _landmarks;
+        /* search reused by the landmark queries, created on demand */
+        std::unique_ptr<Dijkstra> _guided;
+        /* layout of the drawing, valid while `_printer_version` matches */
+        std::unique_ptr<PrintCoordinates> _printer;
+        unsigned long _printer_version = 0;
+        Layout _layout = Layout();
+        PathCache _cache;
+        Arena _scratch;
+        Arena* _arena = nullptr;
+        unsigned long _version = 0;
+        /* tombstones of the removed vertices, `_unpurged` while arcs may
+         * still lead to them */
+        std::vector<char> _removed;
+        int _removed_count = 0;
+        bool _unpurged = false;
+        double _compaction_ratio = 0.25;
+        StorageMode _storage = StorageMode::Csr;
+        bool _frozen = false;
+        bool _directed = false;
+        bool _weighted = false;
+        int _threads = 0;
 };
 } /* namespace ascii_graph */
 
@@ -0,0 +1,88 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __GRAPH_VIEW_H__
+#define __GRAPH_VIEW_H__
+
+#include "bit_matrix.h"
+#include "csr.h"
+#include "neighbor_range.h"
+#include "symbol_table.h"
+
+namespace ascii_graph {
+/**
+ * GraphView
+ * Read-only view of a frozen graph, its vertex names and the arcs of
+ * either storage layout, for code that only walks the graph.
+ *
+ * A view is a few pointers and cheap to pass around, it stays valid until
+ * the graph is modified.
+ */
+class GraphView
+{
+public:
+        GraphView(const SymbolTable& names, const CsrGraph& out,
+                  const CsrGraph& in, bool directed)
+                : _names(&names), _csr_out(&out), _csr_in(&in),
+                  _directed(directed)
+        {
+        }
+        GraphView(const SymbolTable& names, const BitMatrix& out,
+                  const BitMatrix& in, bool directed)
+                : _names(&names), _matrix_out(&out), _matrix_in(&in),
+                  _directed(directed)
+        {
+        }
+        int vertices() const { return _names->size(); }
+        const SymbolTable& names() const { return *_names; }
+        bool directed() const { return _directed; }
+        /* vertices at the end of the arcs leaving `vertex` */
+        NeighborRange neighbors(int vertex) const
+        {
+                if (_matrix_out)
+                        return _matrix_out->neighbors(vertex);
+                return _csr_out->neighbors(vertex);
+        }
+        /* vertices at the start of the arcs entering `vertex` */
+        NeighborRange in_neighbors(int vertex) const
+        {
+                if (_matrix_in)
+                        return _matrix_in->neighbors(vertex);
+                return _csr_in->neighbors(vertex);
+        }
+        bool has_arc(int from, int to) const
+        {
+                if (_matrix_out)
+                        return _matrix_out->test(from, to);
+                return _csr_out->has_arc(from, to);
+        }
+        /* an arc in either direction */
+        bool linked(int one, int two) const
+        {
+                return has_arc(one, two) || (_directed && has_arc(two, one));
+        }
+private:
+        const SymbolTable* _names;
+        const CsrGraph* _csr_out = nullptr;
+        const CsrGraph* _csr_in = nullptr;
+        const BitMatrix* _matrix_out = nullptr;
+        const BitMatrix* _matrix_in = nullptr;
+        bool _directed;
+};
+} /* namespace ascii_graph */
+
+#endif /* __GRAPH_VIEW_H__ */
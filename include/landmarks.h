@@ -0,0 +1,80 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __LANDMARKS_H__
+#define __LANDMARKS_H__
+
+#include <vector>
+#include "csr.h"
+#include "dijkstra.h"
+
+namespace ascii_graph {
+/**
+ * LandmarkIndex
+ * Distances between every vertex and a few landmark vertices, used as the
+ * A* potential of the ALT search (A*, landmarks, triangle inequality).
+ *
+ * For a landmark L the triangle inequality gives the lower bounds
+ * d(v, t) >= d(L, t) - d(L, v) and d(v, t) >= d(v, L) - d(t, L), the bound
+ * of a vertex is the largest one over all landmarks. The landmarks are
+ * picked one after another as the vertex farthest from the ones picked so
+ * far, which spreads them over the periphery of the graph where the bounds
+ * are tight.
+ *
+ * The distances are rounded down to float and stored vertex major,
+ * `from[v * count + l]` is the distance from landmark `l` to `v` and
+ * `to[v * count + l]` the distance back. Undirected graphs only store
+ * `from`. The arrays are either owned or attached from a mapped snapshot.
+ */
+class LandmarkIndex : public Potential
+{
+public:
+        static const int default_count = 16;
+
+        LandmarkIndex();
+        LandmarkIndex(const LandmarkIndex& other);
+        LandmarkIndex& operator=(const LandmarkIndex& other);
+        void build(const CsrGraph& out, const CsrGraph& in, bool directed,
+                   int count = default_count);
+        void attach(const int* landmarks, int count, const float* from,
+                    const float* to, int vertices);
+        void clear();
+        bool empty() const { return _count == 0; }
+        int count() const { return _count; }
+        int vertices() const { return _vertices; }
+        const int* landmarks() const { return _landmark_data; }
+        const float* from() const { return _from_data; }
+        /* same as from() for an undirected graph */
+        const float* to() const { return _to_data; }
+        bool directed() const { return _to_data != _from_data; }
+        double bound(int vertex, int goal) const;
+private:
+        void view();
+        std::vector<int> _landmarks;
+        std::vector<float> _from;
+        std::vector<float> _to;
+        /* the arrays in use, either the vectors above or attached ones */
+        const int* _landmark_data;
+        const float* _from_data;
+        const float* _to_data;
+        int _count;
+        int _vertices;
+        bool _attached;
+};
+} /* namespace ascii_graph */
+
+#endif /* __LANDMARKS_H__ */
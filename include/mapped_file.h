@@ -0,0 +1,55 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+#include <cstddef>
+#include <string>
+
+namespace ascii_graph {
+/**
+ * MappedFile
+ * Read-only memory mapping of a whole file.
+ *
+ * The content is paged in by the kernel on access and can be dropped again
+ * under memory pressure, so files larger than the available RAM can be
+ * read without copying them into the heap.
+ */
+class MappedFile
+{
+public:
+        MappedFile() {}
+        ~MappedFile() { close(); }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        bool open(const std::string& path, bool sequential = true);
+        void close();
+        bool is_open() const { return _data != nullptr || _open_empty; }
+        const char* data() const { return _data; }
+        std::size_t size() const { return _size; }
+        const char* begin() const { return _data; }
+        const char* end() const { return _data + _size; }
+private:
+        const char* _data = nullptr;
+        std::size_t _size = 0;
+        /* an empty file can't be mapped but is still a valid file */
+        bool _open_empty = false;
+};
+} /* namespace ascii_graph */
+
+#endif /* __MAPPED_FILE_H__ */
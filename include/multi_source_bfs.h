@@ -0,0 +1,66 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __MULTI_SOURCE_BFS_H__
+#define __MULTI_SOURCE_BFS_H__
+
+#include <cstdint>
+#include <vector>
+
+namespace ascii_graph {
+/**
+ * MultiSourceBfs
+ * Bit-parallel breadth first search from up to 64 sources at once (MS-BFS,
+ * Then et al.).
+ *
+ * Every vertex carries one word in which bit `i` tells whether the search
+ * from source `i` has seen it, so one pass over an arc advances all searches
+ * that currently visit its tail. Searches sharing parts of the graph share
+ * the memory accesses for them.
+ *
+ * `Adjacency` is CsrGraph or BitMatrix, `out` holds the arcs leaving a
+ * vertex and `in` the arcs entering it (the same object for undirected
+ * graphs).
+ */
+template <typename Adjacency>
+class MultiSourceBfs
+{
+public:
+        static const int lanes = 64;
+
+        MultiSourceBfs(const Adjacency& out, const Adjacency& in);
+        void run(const std::vector<int>& sources);
+        /* hop distance from the source of `lane` to `vertex`, -1 if the
+         * vertex is unreachable */
+        int distance(int lane, int vertex) const
+        {
+                return _distance[static_cast<std::size_t>(vertex) * lanes +
+                                 lane];
+        }
+        std::vector<int> path(int lane, int goal) const;
+private:
+        const Adjacency& _out;
+        const Adjacency& _in;
+        int _count;
+        std::vector<uint64_t> _seen;
+        std::vector<uint64_t> _visit;
+        std::vector<uint64_t> _visit_next;
+        std::vector<int> _distance;
+};
+} /* namespace ascii_graph */
+
+#endif /* __MULTI_SOURCE_BFS_H__ */
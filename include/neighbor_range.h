@@ -0,0 +1,121 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __NEIGHBOR_RANGE_H__
+#define __NEIGHBOR_RANGE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace ascii_graph {
+/**
+ * NeighborRange
+ * The vertices adjacent to one vertex, in ascending order, read in place
+ * from either the targets of a CSR graph or the bits of a matrix row.
+ *
+ * Nothing is copied or allocated, the range stays valid until the graph
+ * it was taken from is modified.
+ */
+class NeighborRange
+{
+public:
+        class iterator
+        {
+        public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef int value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const int* pointer;
+                typedef int reference;
+
+                iterator() {}
+                /* over the targets at `adj` */
+                explicit iterator(const int* adj) : _adj(adj) {}
+                /* over the set bits of `words` words at `row`, starting with
+                 * word `word` */
+                iterator(const uint64_t* row, int word, int words)
+                        : _row(row), _word(word), _words(words)
+                {
+                        if (_word < _words)
+                                _bits = _row[_word];
+                        skip_empty();
+                }
+                int operator*() const
+                {
+                        if (_row)
+                                return _word * 64 + __builtin_ctzll(_bits);
+                        return *_adj;
+                }
+                iterator& operator++()
+                {
+                        if (!_row) {
+                                ++_adj;
+                                return *this;
+                        }
+                        _bits &= _bits - 1;
+                        skip_empty();
+                        return *this;
+                }
+                iterator operator++(int)
+                {
+                        iterator previous = *this;
+                        ++*this;
+                        return previous;
+                }
+                bool operator==(const iterator& other) const
+                {
+                        return _adj == other._adj && _word == other._word &&
+                                _bits == other._bits;
+                }
+                bool operator!=(const iterator& other) const
+                {
+                        return !(*this == other);
+                }
+        private:
+                void skip_empty()
+                {
+                        while (!_bits && _word < _words) {
+                                if (++_word < _words)
+                                        _bits = _row[_word];
+                        }
+                }
+                const int* _adj = nullptr;
+                const uint64_t* _row = nullptr;
+                int _word = 0;
+                int _words = 0;
+                uint64_t _bits = 0;
+        };
+
+        NeighborRange(const int* first, const int* last)
+                : _begin(first), _end(last)
+        {
+        }
+        NeighborRange(const uint64_t* row, int words)
+                : _begin(row, 0, words), _end(row, words, words)
+        {
+        }
+        iterator begin() const { return _begin; }
+        iterator end() const { return _end; }
+        bool empty() const { return _begin == _end; }
+private:
+        iterator _begin;
+        iterator _end;
+};
+} /* namespace ascii_graph */
+
+#endif /* __NEIGHBOR_RANGE_H__ */
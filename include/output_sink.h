@@ -0,0 +1,161 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __OUTPUT_SINK_H__
+#define __OUTPUT_SINK_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ascii_graph {
+/**
+ * OutputSink
+ * Buffered destination of rendered text.
+ *
+ * The renderers write lines into the buffer, which is only handed on to
+ * the destination in large pieces: whenever it is full and on flush().
+ * Nothing is flushed per line. The subclasses deliver the text to a
+ * string, a stream, a file descriptor or a callback and flush what is left
+ * when they are destroyed.
+ */
+class OutputSink
+{
+public:
+        static const std::size_t default_capacity = 1 << 16;
+
+        explicit OutputSink(std::size_t capacity = default_capacity);
+        virtual ~OutputSink() {}
+        OutputSink(const OutputSink&) = delete;
+        OutputSink& operator=(const OutputSink&) = delete;
+        void write(const char* text, std::size_t length)
+        {
+                if (length > _capacity - _used) {
+                        write_large(text, length);
+                        return;
+                }
+                std::copy(text, text + length, _buffer.data() + _used);
+                _used += length;
+        }
+        void write(const char* text)
+        {
+                write(text, std::strlen(text));
+        }
+        void write(const std::string& text)
+        {
+                write(text.data(), text.size());
+        }
+        void put(char character)
+        {
+                if (_used == _capacity)
+                        flush();
+                _buffer[_used++] = character;
+        }
+        /* `count` times `character` */
+        void fill(char character, std::size_t count);
+        void write_integer(long value);
+        /* as many digits as needed to read back the same float */
+        void write_real(double value);
+        void flush();
+protected:
+        /* hand `length` buffered characters on to the destination */
+        virtual void deliver(const char* text, std::size_t length) = 0;
+private:
+        void write_large(const char* text, std::size_t length);
+        std::vector<char> _buffer;
+        std::size_t _capacity;
+        std::size_t _used = 0;
+};
+
+/* Appends to a string */
+class StringSink : public OutputSink
+{
+public:
+        explicit StringSink(std::string& target) : _target(target) {}
+        ~StringSink() { flush(); }
+protected:
+        void deliver(const char* text, std::size_t length)
+        {
+                _target.append(text, length);
+        }
+private:
+        std::string& _target;
+};
+
+/* Writes to a stream, one write() per full buffer */
+class StreamSink : public OutputSink
+{
+public:
+        explicit StreamSink(std::ostream& stream) : _stream(stream) {}
+        ~StreamSink() { flush(); }
+protected:
+        void deliver(const char* text, std::size_t length)
+        {
+                _stream.write(text, length);
+        }
+private:
+        std::ostream& _stream;
+};
+
+/**
+ * FdSink
+ * Writes to a file descriptor, which stays open. A failed write is
+ * reported once and the rest of the output is dropped, see failed().
+ */
+class FdSink : public OutputSink
+{
+public:
+        explicit FdSink(int fd, std::size_t capacity = 1 << 20)
+                : OutputSink(capacity), _fd(fd)
+        {
+        }
+        ~FdSink() { flush(); }
+        bool failed() const { return _failed; }
+protected:
+        void deliver(const char* text, std::size_t length);
+private:
+        int _fd;
+        bool _failed = false;
+};
+
+/* Passes every buffered piece to a function */
+class CallbackSink : public OutputSink
+{
+public:
+        typedef std::function<void(const char*, std::size_t)> Callback;
+
+        explicit CallbackSink(Callback callback,
+                              std::size_t capacity = default_capacity)
+                : OutputSink(capacity), _callback(callback)
+        {
+        }
+        ~CallbackSink() { flush(); }
+protected:
+        void deliver(const char* text, std::size_t length)
+        {
+                _callback(text, length);
+        }
+private:
+        Callback _callback;
+};
+} /* namespace ascii_graph */
+
+#endif /* __OUTPUT_SINK_H__ */
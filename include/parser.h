@@ -19,28 +19,90 @@
 #define __PARSER_H__
 
 #include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
 #include "graph.h"
+#include "dot_lexer.h"
+#include "symbol_table.h"
 
 namespace ascii_graph {
+/**
+ * DotParser
+ * Recursive descent parser for the DOT language.
+ *
+ * The input is tokenized and parsed in a single pass, every vertex is
+ * handed to the graph as soon as it is recognized, the edges are collected
+ * and added in bulk. Of the attributes only the edge weights (`weight` or
+ * `len`) are used, the others are parsed but ignored.
+ *
+ * Streams are parsed in pieces of complete top level statements, so only
+ * the statement currently read has to be kept in memory. Large buffers are
+ * cut into such pieces as well and parsed on several threads.
+ */
 class DotParser
 {
 public:
         bool parse(std::string path, Graph* graph);
-        void get_content(std::vector<std::string> content)
-        {
-                _content = content;
-        }
+        bool parse_content(const std::string& content, Graph* graph);
+        bool parse_stream(std::istream& input, Graph* graph);
+        /* threads used to parse large buffers, 0 for all cores */
+        void set_threads(int threads) { _threads = threads; }
+        /* pieces the last parse handed to worker threads, 0 when it was
+         * parsed sequentially, also after a failed parallel parse */
+        int parallel_pieces() const { return _parallel_pieces; }
 private:
+        /* vertices and edges of a piece parsed on a worker thread, the
+         * vertex ids are local to the piece */
+        struct Chunk {
+                SymbolTable names;
+                std::vector<Arc> edges;
+        };
         std::string _path;
         std::fstream _file;
-        std::vector<std::string> _content;
-        std::vector<std::string> _syntax_lines;
+        DotLexer _lexer;
+        Token _token;
+        Graph* _graph = nullptr;
+        bool _directed = false;
+        /* vertices referenced by the current top level statement, the
+         * operands of an edge statement are slices of it */
+        std::vector<int> _mentioned;
+        /* edges of the current statement, waiting for its attributes */
+        std::vector< std::pair<int, int> > _pending;
+        /* edges parsed so far, handed to the graph in bulk */
+        std::vector<Arc> _edges;
+        /* weight set by the innermost `edge [...]` statement */
+        float _edge_weight = 1;
+        /* line at the start of the next piece */
+        int _line = 1;
+        int _threads = 1;
+        int _parallel_pieces = 0;
+        /* set while parsing a piece on a worker thread */
+        Chunk* _chunk = nullptr;
         bool open_dot_file();
-        bool is_dot_format();
-        void read_content();
-        void get_syntax_lines();
-        std::vector<char> get_vertices();
-        std::vector< std::pair<int, int> > get_links(std::vector<char>);
+        void reset_state(Graph* graph);
+        bool finish(bool parsed);
+        bool parse_buffer(const char* begin, const char* end);
+        bool parse_parallel(const char* begin, const char* end, int threads);
+        int add_vertex(const char* name, std::size_t length);
+        void add_edge(int from, int to, float weight);
+        void flush_edges();
+        bool parse_piece(const char* begin, const char* end, bool first,
+                         bool last);
+        void advance() { _token = _lexer.next(); }
+        bool accept(TokenType type);
+        bool error(const char* expected);
+        bool parse_header();
+        bool parse_statements();
+        bool parse_footer();
+        bool parse_stmt_list();
+        bool parse_stmt();
+        bool parse_attr_list(float* weight);
+        bool parse_weight(float* weight);
+        bool parse_port();
+        bool parse_subgraph();
+        bool parse_operand(std::size_t& first, std::size_t& last);
+        bool parse_edge_rhs(std::size_t first, std::size_t last);
 };
 } /* ascii_graph */
 #endif /* __PARSER_H__ */
@@ -0,0 +1,107 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __PATH_CACHE_H__
+#define __PATH_CACHE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace ascii_graph {
+/* Lookups answered by a PathCache, to size its capacities */
+struct CacheStats {
+        long path_hits = 0;
+        long path_misses = 0;
+        long tree_hits = 0;
+        long tree_misses = 0;
+};
+
+/**
+ * PathCache
+ * Least recently used cache of shortest path results and of BFS trees.
+ *
+ * Paths are keyed by source, goal and algorithm. A tree holds the parent
+ * array of a complete BFS from one source and answers the hop count query
+ * to any goal in O(length). A complete search costs more than one that
+ * stops at the goal, so a tree is only built for a source that is among
+ * the last sources that missed.
+ *
+ * Every entry belongs to a version of the graph, validate() drops them all
+ * once the version changes.
+ */
+class PathCache
+{
+public:
+        PathCache(std::size_t paths = 1024, std::size_t trees = 4);
+        void set_capacity(std::size_t paths, std::size_t trees);
+        void validate(unsigned long version);
+        void clear();
+        const std::vector<int>* find_path(int source, int goal,
+                                          int algorithm);
+        void store_path(int source, int goal, int algorithm,
+                        const std::vector<int>& path);
+        const std::vector<int>* find_tree(int source, bool& wanted);
+        void store_tree(int source, const int* parents, int count);
+        const CacheStats& stats() const { return _stats; }
+private:
+        struct Key {
+                int source;
+                int goal;
+                int algorithm;
+                bool operator==(const Key& other) const
+                {
+                        return source == other.source &&
+                                goal == other.goal &&
+                                algorithm == other.algorithm;
+                }
+        };
+        struct KeyHash {
+                std::size_t operator()(const Key& key) const
+                {
+                        uint64_t value = (uint64_t(uint32_t(key.source)) <<
+                                          32) | uint32_t(key.goal);
+                        value ^= uint64_t(key.algorithm) << 59;
+                        value *= 0x9e3779b97f4a7c15ULL;
+                        return static_cast<std::size_t>(value ^ (value >> 32));
+                }
+        };
+        typedef std::pair< Key, std::vector<int> > PathEntry;
+        typedef std::pair< int, std::vector<int> > TreeEntry;
+        /* sources remembered per tree, to decide which deserve one */
+        static const std::size_t candidates_per_tree = 4;
+        void trim();
+        std::size_t _path_capacity;
+        std::size_t _tree_capacity;
+        unsigned long _version = 0;
+        /* most recently used first */
+        std::list<PathEntry> _paths;
+        std::unordered_map<Key, std::list<PathEntry>::iterator, KeyHash>
+                _path_index;
+        std::list<TreeEntry> _trees;
+        /* sources of the last tree misses, most recent first */
+        std::list<int> _candidates;
+        CacheStats _stats;
+};
+
+std::vector<int> tree_path(const std::vector<int>& parents, int source,
+                           int goal);
+} /* namespace ascii_graph */
+
+#endif /* __PATH_CACHE_H__ */
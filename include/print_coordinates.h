@@ -18,39 +18,95 @@
 #ifndef __PRINT_COORDS_H__
 #define __PRINT_COORDS_H__
 
-#include <iostream>
+#include <string>
 #include <tuple>
 #include <vector>
-#include <algorithm>
+#include "graph_view.h"
+#include "output_sink.h"
 
 namespace ascii_graph {
+/* Window of a drawing: `columns` vertex columns from `first_column` on and
+ * `rows` rows below the head from `first_row` on */
+struct Viewport {
+        int first_column;
+        int columns;
+        int first_row;
+        int rows;
+};
+
+/* Options of the drawing, all off by default: `reorder` orders the
+ * columns to shorten the edges, `pack` lets edges that don't overlap share
+ * a row */
+struct Layout {
+        bool reorder;
+        bool pack;
+};
+
+/**
+ * PrintCoordinates
+ * ASCII drawing of a graph, one column per vertex.
+ *
+ * The head lists the vertices, edges between neighboring columns are drawn
+ * in it. Every other edge gets a row of its own, the shortest ones first,
+ * with vertical lines from the head down to the row of the last edge of a
+ * column. The rows are laid out once by a sweep over the sorted edges,
+ * which records where the vertical line of every column ends, so each cell
+ * is decided in O(1) and the whole drawing written in time linear in its
+ * size. A viewport only writes the cells inside it, each line of it is
+ * the same part of the line of the whole drawing.
+ *
+ * The layout can shorten the drawing: a reverse Cuthill-McKee order of
+ * the columns pulls linked vertices together, it is kept when the edges
+ * span fewer columns than in the order of the graph. Packed rows take as
+ * many edges as fit side by side, the edges are assigned by start column
+ * to the row that ended the earliest, which needs as many rows as edges
+ * overlap at one column.
+ */
 class PrintCoordinates
 {
 public:
-        PrintCoordinates(std::vector<char> v, std::vector< std::vector<int> > m)
-        {
-                this->_vertices = v;
-                this->_adj_matrix = m;
-        }
-        void print_head();
-        int print_point(int row, int col);
+        explicit PrintCoordinates(const GraphView& graph,
+                                  const Layout& layout = Layout());
+        /* the columns `first` .. `last` - 1, all by default */
+        void print_head(OutputSink& sink, int first = 0, int last = -1);
+        void print_row(int row, OutputSink& sink, int first = 0,
+                       int last = -1);
+        /* the head and all rows */
+        void print(OutputSink& sink);
+        /* the head and the rows within `viewport` */
+        void print(OutputSink& sink, const Viewport& viewport);
+        int columns() const { return _graph.vertices(); }
         int rows()
         {
-                return (2 * static_cast<int>(_edges.size()));
+                return (2 * (static_cast<int>(_row_begin.size()) - 1));
         }
+        /* vertex drawn in column `col` */
+        int vertex(int col) const { return _order[col]; }
 private:
-        char get_char_for_point(int row, int col);
+        char get_char_for_point(int row, int col, int edge_start,
+                                int edge_end);
+        void linked_vertices(int vertex, std::vector<int>& linked);
+        void order_columns();
+        long span();
         void get_edges_with_min_distance();
-        std::tuple<int, int, int> get_active_edge(int row);
-        std::vector<char> _vertices;
-        std::vector< std::vector<int> > _adj_matrix;
+        void pack_rows();
+        GraphView _graph;
+        Layout _layout;
+        /* vertex of every column and column of every vertex */
+        std::vector<int> _order;
+        std::vector<int> _column;
+        /* start and end column and row of the edges drawn in rows, sorted
+         * by row and start, the edges of row k begin at _row_begin[k] */
         std::vector<std::tuple<int, int, int>> _edges;
-        std::string _connect = "----";
-        std::string _space = "    ";
+        std::vector<int> _row_begin;
+        /* row of the last edge of every column, -1 for none */
+        std::vector<int> _vertical_end;
+        int _width;
+        std::string _connect;
+        std::string _space;
 };
 
 bool sort_by_distance(std::tuple<int, int, int> edge1,
                       std::tuple<int, int, int> edge2);
-// int add_special_x(int a, int b) { return a + b; }
 } /* namespace ascii_graph */
 #endif
@@ -0,0 +1,69 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <string>
+#include "csr.h"
+#include "landmarks.h"
+#include "mapped_file.h"
+#include "symbol_table.h"
+
+namespace ascii_graph {
+struct SnapshotHeader;
+
+/**
+ * Snapshot
+ * Binary image of a frozen graph, loaded by mapping it into memory.
+ *
+ * The file starts with a versioned header, followed by the sections holding
+ * the name arena, the name offsets, the hash slots of the symbol table, the
+ * CSR offsets and targets and, for directed graphs, the CSR arrays of the
+ * reverse arcs. Weighted graphs add the arc weights of both, a graph with a
+ * landmark index adds the landmarks and their distances. Every section is
+ * 8 byte aligned and stored in the in-memory layout of its array, so a
+ * loaded graph uses the mapping directly instead of parsing or copying it.
+ * The header and every section carry a checksum.
+ */
+class Snapshot
+{
+public:
+        static bool write(const std::string& path, const SymbolTable& names,
+                          const CsrGraph& csr, const CsrGraph* reverse,
+                          const LandmarkIndex* landmarks = nullptr);
+        bool open(const std::string& path, bool verify = true);
+        void close();
+        void attach(SymbolTable* names, CsrGraph* csr, CsrGraph* reverse,
+                    LandmarkIndex* landmarks) const;
+        int vertices() const;
+        bool directed() const;
+        bool weighted() const;
+        int landmark_count() const;
+private:
+        const char* section(int index) const;
+        bool check_layout();
+        bool check_csr(int offsets_section, int targets_section) const;
+        bool check_weights(int weights_section) const;
+        bool check_landmarks() const;
+        bool check_content() const;
+        MappedFile _file;
+        const SnapshotHeader* _header = nullptr;
+};
+} /* namespace ascii_graph */
+
+#endif /* __SNAPSHOT_H__ */
@@ -0,0 +1,102 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef __SYMBOL_TABLE_H__
+#define __SYMBOL_TABLE_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ascii_graph {
+/**
+ * SymbolTable
+ * Interned vertex names mapped to dense ids 0 .. size() - 1.
+ *
+ * The characters of all names are stored back to back in one arena, name
+ * `id` spans `arena[offsets[id]] .. arena[offsets[id + 1] - 1]`. An open
+ * addressing hash index (linear probing, at most half full) maps a name to
+ * its id in O(1), each slot caches the hash of its name so that probing
+ * rarely has to compare characters.
+ *
+ * The table can also be attached to the arrays of a mapped snapshot, they
+ * are only copied when a new name is interned.
+ */
+class SymbolTable
+{
+public:
+        struct Slot {
+                uint32_t hash;
+                int id;
+        };
+        SymbolTable() : _offsets(1, 0) { view(); }
+        SymbolTable(const SymbolTable& other);
+        SymbolTable& operator=(const SymbolTable& other);
+        int intern(const char* name, std::size_t length);
+        int intern(const std::string& name)
+        {
+                return intern(name.data(), name.size());
+        }
+        int find(const char* name, std::size_t length) const;
+        int find(const std::string& name) const
+        {
+                return find(name.data(), name.size());
+        }
+        const char* data(int id) const
+        {
+                return _arena_data + _offset_data[id];
+        }
+        std::size_t length(int id) const
+        {
+                return _offset_data[id + 1] - _offset_data[id];
+        }
+        std::string name(int id) const
+        {
+                return std::string(data(id), length(id));
+        }
+        int size() const { return _count; }
+        void reserve(std::size_t names, std::size_t characters);
+        void clear();
+        /* raw storage, as written to a snapshot */
+        const char* arena() const { return _arena_data; }
+        std::size_t arena_size() const { return _offset_data[_count]; }
+        const uint64_t* offsets() const { return _offset_data; }
+        const Slot* slots() const { return _slot_data; }
+        std::size_t slot_count() const { return _slot_count; }
+        void attach(const char* arena, const uint64_t* offsets, int count,
+                    const Slot* slots, std::size_t slot_count);
+private:
+        static uint64_t hash(const char* name, std::size_t length);
+        std::size_t probe(const char* name, std::size_t length,
+                          uint64_t name_hash) const;
+        void grow(std::size_t capacity);
+        void view();
+        void own();
+        std::vector<char> _arena;
+        std::vector<uint64_t> _offsets;
+        std::vector<Slot> _slots;
+        /* the arrays in use, either the vectors above or attached ones */
+        const char* _arena_data;
+        const uint64_t* _offset_data;
+        const Slot* _slot_data;
+        std::size_t _slot_count;
+        int _count;
+        bool _attached = false;
+};
+} /* namespace ascii_graph */
+
+#endif /* __SYMBOL_TABLE_H__ */
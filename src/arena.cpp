@@ -0,0 +1,92 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstdint>
+#include "arena.h"
+
+namespace ascii_graph {
+/**
+ * allocate
+ * Return `size` bytes aligned to `alignment`, a power of two no larger
+ * than the alignment of the heap.
+ */
+void* Arena::allocate(std::size_t size, std::size_t alignment)
+{
+        _stats.allocations++;
+        _stats.bytes += size;
+        while (_block < _blocks.size()) {
+                Block& block = _blocks[_block];
+                uintptr_t start = reinterpret_cast<uintptr_t>(block.data) +
+                        _used;
+                std::size_t padding = (alignment - start % alignment) %
+                        alignment;
+                if (size <= block.size - _used &&
+                    padding <= block.size - _used - size) {
+                        _used += padding + size;
+                        return block.data + _used - size;
+                }
+                /* the rest of a block that is too small stays unused until
+                 * the arena is rewound */
+                _block++;
+                _used = 0;
+        }
+
+        std::size_t block_size = _blocks.empty() ? _block_size :
+                2 * _blocks.back().size;
+        block_size = std::max(block_size, size);
+        Block block = {
+                static_cast<char*>(::operator new(block_size)), block_size
+        };
+        _blocks.push_back(block);
+        _stats.blocks++;
+        _stats.reserved += block_size;
+        _block = _blocks.size() - 1;
+        _used = size;
+        return block.data;
+}
+
+/* Only the latest allocation is given back, the others stay in use */
+void Arena::deallocate(void* pointer, std::size_t size)
+{
+        if (_block < _blocks.size() &&
+            static_cast<char*>(pointer) + size ==
+            _blocks[_block].data + _used)
+                _used -= size;
+}
+
+/**
+ * rewind
+ * Free everything allocated since `position` was taken with mark().
+ */
+void Arena::rewind(const Mark& position)
+{
+        _block = position.block;
+        _used = position.used;
+}
+
+/* Give all blocks back to the heap */
+void Arena::release()
+{
+        for (auto& block : _blocks) {
+                ::operator delete(block.data);
+        }
+        _blocks.clear();
+        _block = _used = 0;
+        _stats.reserved = 0;
+}
+} /* namespace ascii_graph */
@@ -16,7 +16,9 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
 #include <unistd.h>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
 #include "graph.h"
 #include "parser.h"
 
@@ -49,39 +51,111 @@ void print_help()
 {
         std::cout << "Usage: asciigraph [options]" << std::endl << std::endl;
         std::cout << "Options:" << std::endl;
-        std::cout << "\t-f\t-\tRead a graph from a file with a DOT-format."
-                  << std::endl;
+        std::cout << "\t-f\t-\tRead a graph from a file with a DOT-format "
+                  << "('-' reads the standard input)." << std::endl;
+        std::cout << "\t-l\t-\tLoad a graph from a binary snapshot "
+                  << "instead of a DOT file." << std::endl;
+        std::cout << "\t-s\t-\tStore the graph as a binary snapshot, "
+                  << "e.g. -f graph.dot -s graph.snap." << std::endl;
+        std::cout << "\t-L\t-\tBuild a landmark index with the given "
+                  << "number of landmarks for fast repeated path queries, "
+                  << "stored with -s." << std::endl;
         std::cout << "\t-d\t-\tCreate a dummy graph with sample values."
                   << std::endl;
-        std::cout << "\t-m\t-\tPrint the adjancency matrix." << std::endl;
+        std::cout << "\t-b\t-\tStore the graph as a bit-packed adjacency "
+                  << "matrix (for dense graphs)." << std::endl;
+        std::cout << "\t-t\t-\tParse large files and search shortest "
+                  << "paths on the given number of threads (0 = all cores)."
+                  << std::endl;
+        std::cout << "\t-m\t-\tPrint the adjancency matrix, optionally in "
+                  << "another format: dense (default), edges, mtx (Matrix "
+                  << "Market) or rle (run lengths)." << std::endl;
         std::cout << "\t-a\t-\tPrint the ASCII graph." << std::endl;
+        std::cout << "\t-c\t-\tDraw the ASCII graph compact: reorder the "
+                  << "vertices to shorten the edges and share rows between "
+                  << "edges." << std::endl;
         std::cout << "\t-i\t-\tUse the interactive mode "
                   << "to work with a given graph." << std::endl;
         std::cout << "\t-h\t-\tPrint this text." << std::endl;
 }
 
-void interactive_loop(Graph *graph)
+bool read_matrix_format(const std::string& name, MatrixFormat* format)
+{
+        if (name == "dense")
+                *format = MatrixFormat::Dense;
+        else if (name == "edges")
+                *format = MatrixFormat::EdgeList;
+        else if (name == "mtx")
+                *format = MatrixFormat::MatrixMarket;
+        else if (name == "rle")
+                *format = MatrixFormat::RunLength;
+        else
+                return false;
+        return true;
+}
+
+PathAlgorithm read_algorithm(PathAlgorithm current)
+{
+        std::string name;
+        std::cout << "Algorithm (bfs, parallel, bidirectional, dijkstra, "
+                  << "delta, alt): ";
+        std::cin >> name;
+        if (name == "bfs")
+                return PathAlgorithm::Bfs;
+        if (name == "parallel")
+                return PathAlgorithm::ParallelBfs;
+        if (name == "bidirectional")
+                return PathAlgorithm::BidirectionalBfs;
+        if (name == "dijkstra")
+                return PathAlgorithm::Dijkstra;
+        if (name == "delta")
+                return PathAlgorithm::DeltaStepping;
+        if (name == "alt")
+                return PathAlgorithm::Landmarks;
+        std::cerr << "Unknown algorithm: " << name << std::endl;
+        return current;
+}
+
+/* read a number for `prompt`, false on input that isn't one */
+bool read_number(const char* prompt, int* number)
+{
+        std::cout << prompt;
+        if (std::cin >> *number)
+                return true;
+        if (std::cin.eof())
+                return false;
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cerr << "Not a number" << std::endl;
+        return false;
+}
+
+void interactive_loop(Graph *graph, PathAlgorithm algorithm)
 {
         std::string command;
         while (command != "q" && command != "end" && command != "quit") {
                 std::cout << "Enter command: (l for list of commands)"
                           << std::endl;
-                std::cin >> command;
+                if (!(std::cin >> command))
+                        break;
                 if (command == "list" || command == "l") {
                         std::cout << "shortest_path (sp)\t\t|\tprint_ascii (p)"
                                   << std::endl
                                   << "print_matrix (m)\t\t|\tlist (l)"
                                   << std::endl
-                                  << "quit (q)"
-                                  << std::endl;
+                                  << "algorithm (alg)\t\t\t|\tcache (c)"
+                                  << std::endl
+                                  << "view (v)\t\t\t|\tneighborhood (n)"
+                                  << std::endl
+                                  << "quit (q)" << std::endl;
                 } else if (command == "shortest_path" || command == "sp") {
-                        char from, to;
+                        std::string from, to;
                         std::cout << "From: ";
                         std::cin >> from;
                         std::cout << "To: ";
                         std::cin >> to;
-                        std::vector<char> path;
-                        path = graph->get_shortest_path(from, to);
+                        std::vector<std::string> path;
+                        path = graph->get_shortest_path(from, to, algorithm);
                         std::cout << "Shortest path from " << from
                                   << " to " << to << ":" << std::endl;
                         for (auto p = path.begin() ; p != path.end() ; ++p) {
@@ -90,10 +164,45 @@ void interactive_loop(Graph *graph)
                                         std::cout << "->";
                         }
                         std::cout << std::endl;
+                        if (graph->weighted() && !path.empty())
+                                std::cout << "Distance: "
+                                          << graph->get_shortest_distance(
+                                                  from, to, algorithm)
+                                          << std::endl;
+                } else if (command == "cache" || command == "c") {
+                        const CacheStats& stats = graph->cache_stats();
+                        std::cout << "Path cache: " << stats.path_hits
+                                  << " hits, " << stats.path_misses
+                                  << " misses" << std::endl
+                                  << "BFS tree cache: " << stats.tree_hits
+                                  << " hits, " << stats.tree_misses
+                                  << " misses" << std::endl;
+                        const ArenaStats& arena = graph->arena_stats();
+                        std::cout << "Search arena: " << arena.allocations
+                                  << " allocations in " << arena.blocks
+                                  << " blocks, " << arena.reserved / 1024
+                                  << " KiB held" << std::endl;
+                } else if (command == "algorithm" || command == "alg") {
+                        algorithm = read_algorithm(algorithm);
                 } else if (command == "print_ascii" || command == "p") {
                         graph->print_graph();
                 } else if (command == "print_matrix" || command == "m") {
                         graph->print_matrix();
+                } else if (command == "view" || command == "v") {
+                        Viewport viewport;
+                        if (read_number("First column: ",
+                                        &viewport.first_column) &&
+                            read_number("Columns: ", &viewport.columns) &&
+                            read_number("First row: ", &viewport.first_row) &&
+                            read_number("Rows: ", &viewport.rows))
+                                graph->print_graph(viewport);
+                } else if (command == "neighborhood" || command == "n") {
+                        std::string center;
+                        int radius;
+                        std::cout << "Vertex: ";
+                        std::cin >> center;
+                        if (read_number("Radius: ", &radius))
+                                graph->print_neighborhood(center, radius);
                 }
         }
 }
@@ -103,23 +212,61 @@ int main(int argc, char *argv[])
         int opt;
         Graph graph;
         DotParser parser;
+        PathAlgorithm algorithm = PathAlgorithm::Bfs;
+        MatrixFormat matrix_format = MatrixFormat::Dense;
+        const char* format;
+        std::string path, snapshot_in, snapshot_out;
+        int landmarks = 0;
         bool with_matrix, with_ascii_graph, interactive;
         with_matrix = with_ascii_graph = interactive = false;
 
-        while ((opt = getopt(argc, argv, "f:dmaih")) != -1) {
+        while ((opt = getopt(argc, argv, "f:l:s:L:bdt:m::acih")) != -1) {
                 switch (opt) {
                 case 'f':
-                        parser.parse(optarg, &graph);
+                        path = optarg;
+                        break;
+                case 'l':
+                        snapshot_in = optarg;
+                        break;
+                case 's':
+                        snapshot_out = optarg;
+                        break;
+                case 'L':
+                        landmarks = atoi(optarg);
+                        break;
+                case 'b':
+                        graph.set_storage(StorageMode::BitMatrix);
                         break;
                 case 'd':
                         create_dummy_graph(&graph);
                         break;
+                case 't':
+                        graph.set_threads(atoi(optarg));
+                        parser.set_threads(atoi(optarg));
+                        algorithm = PathAlgorithm::ParallelBfs;
+                        break;
                 case 'm':
                         with_matrix = true;
+                        /* the format may follow as the next argument */
+                        format = optarg;
+                        if (!format && optind < argc &&
+                            argv[optind][0] != '-')
+                                format = argv[optind++];
+                        if (format &&
+                            !read_matrix_format(format, &matrix_format)) {
+                                std::cerr << "Unknown matrix format: "
+                                          << format << std::endl;
+                                return 1;
+                        }
                         break;
                 case 'a':
                         with_ascii_graph = true;
                         break;
+                case 'c': {
+                        Layout compact = { true, true };
+                        graph.set_layout(compact);
+                        break;
+                }
                 case 'i':
                         interactive = true;
                         break;
@@ -133,12 +280,30 @@ int main(int argc, char *argv[])
                 }
         }
 
+        if (!path.empty() && !snapshot_in.empty()) {
+                std::cerr << "Options -f and -l can't be combined"
+                          << std::endl;
+                return 1;
+        }
+        /* parsed after all options, so that -t applies to the parser too */
+        if (!path.empty())
+                parser.parse(path, &graph);
+        else if (!snapshot_in.empty() && !graph.load_snapshot(snapshot_in))
+                return 1;
+        if (landmarks > 0 && !graph.empty())
+                graph.build_landmarks(landmarks);
+        /* an index built or loaded is there to answer the queries */
+        if (graph.has_landmarks())
+                algorithm = PathAlgorithm::Landmarks;
+        if (!snapshot_out.empty() && !graph.empty() &&
+            !graph.save_snapshot(snapshot_out))
+                return 1;
         if (with_matrix && !graph.empty())
-                graph.print_matrix();
+                graph.print_matrix(matrix_format);
         if (with_ascii_graph && !graph.empty())
                 graph.print_graph();
         if (interactive && !graph.empty()) {
-                interactive_loop(&graph);
+                interactive_loop(&graph, algorithm);
         }
         return 0;
 }
@@ -0,0 +1,330 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include "bfs.h"
+#include "csr.h"
+#include "bit_matrix.h"
+
+namespace ascii_graph {
+static bool test_bit(const ArenaVector<uint64_t>& bits, int vertex)
+{
+        return (bits[vertex / 64] >> (vertex % 64)) & 1;
+}
+
+/**
+ * find_parent
+ * Return the first neighbor of `vertex` that is part of the frontier bitmap,
+ * or -1 when there is none.
+ */
+static int find_parent(const CsrGraph& adjacency, int vertex,
+                       const ArenaVector<uint64_t>& frontier)
+{
+        for (const int* adj = adjacency.begin(vertex) ;
+             adj != adjacency.end(vertex) ; ++adj) {
+                if (test_bit(frontier, *adj))
+                        return *adj;
+        }
+        return -1;
+}
+
+static int find_parent(const BitMatrix& adjacency, int vertex,
+                       const ArenaVector<uint64_t>& frontier)
+{
+        /* intersect the matrix row with the frontier, a word at a time */
+        const uint64_t* row = adjacency.row(vertex);
+        int words = static_cast<int>(frontier.size());
+        for (int word = 0 ; word < words ; word++) {
+                uint64_t common = row[word] & frontier[word];
+                if (common)
+                        return word * 64 + __builtin_ctzll(common);
+        }
+        return -1;
+}
+
+template <typename Adjacency>
+BfsEngine<Adjacency>::BfsEngine(const Adjacency& out, const Adjacency& in,
+                                Arena* arena)
+        : _out(out), _in(in), _count(out.vertices()), _visited(arena),
+          _frontier_bits(arena), _next_bits(arena), _frontier(arena),
+          _next(arena), _parent(arena)
+{
+}
+
+template <typename Adjacency>
+void BfsEngine<Adjacency>::mark(int vertex, int parent)
+{
+        _visited[vertex / 64] |= uint64_t(1) << (vertex % 64);
+        _parent[vertex] = parent;
+}
+
+/**
+ * top_down_step
+ * Expand every vertex of the frontier queue into the next queue.
+ * Returns the size of the next frontier, `arcs` is set to the number of
+ * arcs leaving it.
+ */
+template <typename Adjacency>
+long BfsEngine<Adjacency>::top_down_step(long& arcs)
+{
+        arcs = 0;
+        _next.clear();
+        for (auto& vertex : _frontier) {
+                _out.for_each(vertex, [&](int adj) {
+                        if (visited(adj))
+                                return;
+                        mark(adj, vertex);
+                        _next.push_back(adj);
+                        arcs += _out.degree(adj);
+                });
+        }
+        _frontier.swap(_next);
+        return static_cast<long>(_frontier.size());
+}
+
+/**
+ * bottom_up_step
+ * Let every unvisited vertex search its incoming arcs for a parent within
+ * the frontier bitmap. Returns the size of the next frontier, `arcs` is set
+ * to the number of arcs leaving it.
+ */
+template <typename Adjacency>
+long BfsEngine<Adjacency>::bottom_up_step(long& arcs)
+{
+        long next_count = 0;
+        arcs = 0;
+        std::fill(_next_bits.begin(), _next_bits.end(), 0);
+        for (int vertex = 0 ; vertex < _count ; vertex++) {
+                if (visited(vertex))
+                        continue;
+                /* only the frontier bitmap is searched, so vertices marked
+                 * during this sweep can't become parents in the same level */
+                int parent = find_parent(_in, vertex, _frontier_bits);
+                if (parent < 0)
+                        continue;
+                mark(vertex, parent);
+                _next_bits[vertex / 64] |= uint64_t(1) << (vertex % 64);
+                arcs += _out.degree(vertex);
+                next_count++;
+        }
+        _frontier_bits.swap(_next_bits);
+        return next_count;
+}
+
+template <typename Adjacency>
+void BfsEngine<Adjacency>::frontier_to_bitmap()
+{
+        std::fill(_frontier_bits.begin(), _frontier_bits.end(), 0);
+        for (auto& vertex : _frontier) {
+                _frontier_bits[vertex / 64] |= uint64_t(1) << (vertex % 64);
+        }
+}
+
+template <typename Adjacency>
+void BfsEngine<Adjacency>::bitmap_to_frontier()
+{
+        _frontier.clear();
+        int words = static_cast<int>(_frontier_bits.size());
+        for (int word = 0 ; word < words ; word++) {
+                uint64_t value = _frontier_bits[word];
+                while (value) {
+                        _frontier.push_back(word * 64 +
+                                            __builtin_ctzll(value));
+                        value &= value - 1;
+                }
+        }
+}
+
+/**
+ * run
+ * Search from `source` until `goal` is reached, or through the whole
+ * component of `source` when `goal` is -1.
+ */
+template <typename Adjacency>
+void BfsEngine<Adjacency>::run(int source, int goal)
+{
+        int words = (_count + 63) / 64;
+        _visited.assign(words, 0);
+        _frontier_bits.assign(words, 0);
+        _next_bits.assign(words, 0);
+        _parent.assign(_count, -1);
+        _frontier.clear();
+        _top_down_steps = _bottom_up_steps = 0;
+
+        mark(source, -1);
+        _frontier.push_back(source);
+        long frontier_arcs = _out.degree(source);
+        long frontier_count = 1;
+        long unexplored_arcs = static_cast<long>(_out.arcs()) - frontier_arcs;
+        bool bottom_up = false;
+
+        while (frontier_count > 0) {
+                if (goal >= 0 && visited(goal))
+                        break;
+                if (!bottom_up && frontier_arcs > unexplored_arcs / _alpha) {
+                        frontier_to_bitmap();
+                        bottom_up = true;
+                } else if (bottom_up && frontier_count < _count / _beta) {
+                        bitmap_to_frontier();
+                        bottom_up = false;
+                }
+
+                if (bottom_up) {
+                        frontier_count = bottom_up_step(frontier_arcs);
+                        _bottom_up_steps++;
+                } else {
+                        frontier_count = top_down_step(frontier_arcs);
+                        _top_down_steps++;
+                }
+                unexplored_arcs -= frontier_arcs;
+        }
+}
+
+/**
+ * path
+ * Walk the parent array from `goal` back to the source.
+ * Returns an empty path when `goal` wasn't reached.
+ */
+template <typename Adjacency>
+std::vector<int> BfsEngine<Adjacency>::path(int goal) const
+{
+        std::vector<int> result;
+        if (goal < 0 || !visited(goal))
+                return result;
+        for (int next = goal ; next >= 0 ; next = _parent[next]) {
+                result.push_back(next);
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+}
+
+template <typename Adjacency>
+BidirectionalBfs<Adjacency>::BidirectionalBfs(const Adjacency& out,
+                                              const Adjacency& in,
+                                              Arena* arena)
+        : _out(out), _in(in), _count(out.vertices()), _forward(arena),
+          _backward(arena)
+{
+}
+
+/**
+ * expand
+ * Expand one complete level of `side`, `on_meet` is called with the arc
+ * (vertex, adj) whenever `adj` was already reached by `other`.
+ */
+template <typename Adjacency>
+template <typename Function>
+void BidirectionalBfs<Adjacency>::expand(const Adjacency& adjacency,
+                                         Side& side, Side& other,
+                                         Function on_meet)
+{
+        side.next.clear();
+        side.arcs = 0;
+        for (auto& vertex : side.frontier) {
+                adjacency.for_each(vertex, [&](int adj) {
+                        if (other.distance[adj] >= 0)
+                                on_meet(vertex, adj);
+                        if (side.distance[adj] >= 0)
+                                return;
+                        side.distance[adj] = side.distance[vertex] + 1;
+                        side.parent[adj] = vertex;
+                        side.next.push_back(adj);
+                        side.arcs += adjacency.degree(adj);
+                        _explored++;
+                });
+        }
+        side.frontier.swap(side.next);
+}
+
+/**
+ * run
+ * Returns the vertices of a shortest path from `source` to `goal`, or an
+ * empty path when there is none.
+ */
+template <typename Adjacency>
+std::vector<int> BidirectionalBfs<Adjacency>::run(int source, int goal)
+{
+        std::vector<int> path;
+        Side* sides[] = { &_forward, &_backward };
+        for (auto& side : sides) {
+                side->distance.assign(_count, -1);
+                side->parent.assign(_count, -1);
+                side->frontier.clear();
+        }
+        _forward.distance[source] = 0;
+        _forward.frontier.push_back(source);
+        _forward.arcs = _out.degree(source);
+        _backward.distance[goal] = 0;
+        _backward.frontier.push_back(goal);
+        _backward.arcs = _in.degree(goal);
+        _explored = source == goal ? 1 : 2;
+
+        /* best connection: forward vertex, backward vertex, path length */
+        int meet_forward = -1;
+        int meet_backward = -1;
+        int best = source == goal ? 0 : -1;
+        if (best == 0)
+                meet_forward = meet_backward = source;
+
+        while (best < 0 && !_forward.frontier.empty() &&
+               !_backward.frontier.empty()) {
+                if (_forward.arcs <= _backward.arcs) {
+                        expand(_out, _forward, _backward,
+                               [&](int vertex, int adj) {
+                                int length = _forward.distance[vertex] + 1 +
+                                        _backward.distance[adj];
+                                if (best < 0 || length < best) {
+                                        best = length;
+                                        meet_forward = vertex;
+                                        meet_backward = adj;
+                                }
+                        });
+                } else {
+                        expand(_in, _backward, _forward,
+                               [&](int vertex, int adj) {
+                                int length = _backward.distance[vertex] + 1 +
+                                        _forward.distance[adj];
+                                if (best < 0 || length < best) {
+                                        best = length;
+                                        meet_forward = adj;
+                                        meet_backward = vertex;
+                                }
+                        });
+                }
+        }
+        if (best < 0)
+                return path;
+
+        for (int next = meet_forward ; next >= 0 ;
+             next = _forward.parent[next]) {
+                path.push_back(next);
+        }
+        std::reverse(path.begin(), path.end());
+        if (meet_backward == meet_forward)
+                meet_backward = _backward.parent[meet_backward];
+        for (int next = meet_backward ; next >= 0 ;
+             next = _backward.parent[next]) {
+                path.push_back(next);
+        }
+        return path;
+}
+
+template class BfsEngine<CsrGraph>;
+template class BfsEngine<BitMatrix>;
+template class BidirectionalBfs<CsrGraph>;
+template class BidirectionalBfs<BitMatrix>;
+} /* namespace ascii_graph */
@@ -0,0 +1,90 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "bit_matrix.h"
+
+namespace ascii_graph {
+/**
+ * freeze
+ * Set the bits for all arcs of the builder, the builder is empty afterwards.
+ *
+ * The arcs pass through a CSR graph, which collects the bulk arcs.
+ */
+void BitMatrix::freeze(CsrBuilder& builder)
+{
+        CsrGraph csr;
+        csr.freeze(builder);
+        assign(csr);
+}
+
+/**
+ * assign
+ * Set the bits for all arcs of a frozen CSR graph, which stays as is.
+ */
+void BitMatrix::assign(const CsrGraph& csr)
+{
+        reset(csr.vertices());
+        for (int vertex = 0 ; vertex < _vertices ; vertex++) {
+                csr.for_each(vertex, [&](int target) {
+                        set(vertex, target);
+                });
+        }
+}
+
+/* an empty matrix of `vertices` rows */
+void BitMatrix::reset(int vertices)
+{
+        _vertices = vertices;
+        int words = (_vertices + 63) / 64;
+        _stride = (words + block_words - 1) / block_words * block_words;
+        _bits.assign(static_cast<std::size_t>(_vertices) * _stride, 0);
+        _degrees.assign(_vertices, 0);
+        _arcs = 0;
+}
+
+void BitMatrix::set(int from, int to)
+{
+        uint64_t* bits = _bits.data() + static_cast<std::size_t>(from) *
+                _stride;
+        uint64_t bit = uint64_t(1) << (to % 64);
+        if (!(bits[to / 64] & bit)) {
+                _arcs++;
+                _degrees[from]++;
+        }
+        bits[to / 64] |= bit;
+}
+
+/**
+ * thaw
+ * Turn the set bits back into adjacency lists and release the matrix.
+ */
+void BitMatrix::thaw(CsrBuilder& builder)
+{
+        builder.clear();
+        for (int vertex = 0 ; vertex < _vertices ; vertex++) {
+                builder.add_vertex();
+                for_each(vertex, [&](int target) {
+                        builder.add_arc(vertex, target);
+                });
+        }
+        _vertices = 0;
+        _arcs = 0;
+        _stride = 0;
+        std::vector< uint64_t, AlignedAllocator<uint64_t, 32> >().swap(_bits);
+        std::vector<int>().swap(_degrees);
+}
+} /* namespace ascii_graph */
@@ -0,0 +1,211 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <limits>
+#include "concurrent_graph.h"
+#include "bfs.h"
+#include "dijkstra.h"
+
+namespace ascii_graph {
+ConcurrentGraph::ConcurrentGraph() : _current(nullptr)
+{
+        publish();
+}
+
+/* no reader may be left, the domain frees the retired versions */
+ConcurrentGraph::~ConcurrentGraph()
+{
+        delete _current.load();
+}
+
+/**
+ * update
+ * Apply `change` to the private graph and publish the result as the next
+ * version. Readers keep the version they pinned, the ones entering after
+ * the swap see the new one.
+ */
+void ConcurrentGraph::update(const std::function<void(Graph&)>& change)
+{
+        std::lock_guard<std::mutex> lock(_writer);
+        change(_graph);
+        publish();
+}
+
+/**
+ * publish
+ * Copy the frozen graph into a new version, swap it in and retire the
+ * previous one. The versions are kept as CSR arrays whatever the storage
+ * of the graph.
+ */
+void ConcurrentGraph::publish()
+{
+        if (_graph.storage() != StorageMode::Csr)
+                _graph.set_storage(StorageMode::Csr);
+        _graph.freeze();
+
+        Version* version = new Version();
+        version->names = _graph._names;
+        version->out = _graph._csr;
+        if (_graph._directed)
+                version->in = _graph._csr_in;
+        version->landmarks = _graph._landmarks;
+        version->removed = _graph._removed;
+        version->snapshot = _graph._snapshot;
+        version->number = _updates++;
+        version->directed = _graph._directed;
+        version->weighted = _graph._weighted;
+
+        const Version* previous = _current.exchange(version);
+        if (previous) {
+                _epochs.retire([previous]() { delete previous; });
+                _epochs.collect();
+        }
+}
+
+unsigned long ConcurrentGraph::version() const
+{
+        return Reader(*this).version();
+}
+
+ConcurrentGraph::Reader::Reader(const ConcurrentGraph& graph)
+        : _guard(graph._epochs), _version(graph._current.load())
+{
+}
+
+unsigned long ConcurrentGraph::Reader::version() const
+{
+        return _version->number;
+}
+
+int ConcurrentGraph::Reader::vertices() const
+{
+        return _version->names.size();
+}
+
+int ConcurrentGraph::Reader::vertex_index(const std::string& name) const
+{
+        return find(name);
+}
+
+/* index of the vertex called `name`, -1 for none or a removed one */
+int ConcurrentGraph::Reader::find(const std::string& name) const
+{
+        const std::vector<char>& removed = _version->removed;
+        int index = _version->names.find(name);
+        if (index >= 0 && index < static_cast<int>(removed.size()) &&
+            removed[index])
+                return -1;
+        return index;
+}
+
+std::string ConcurrentGraph::Reader::vertex_name(int index) const
+{
+        return _version->names.name(index);
+}
+
+bool ConcurrentGraph::Reader::directed() const
+{
+        return _version->directed;
+}
+
+/* read-only view of the pinned version, valid while the reader lives */
+GraphView ConcurrentGraph::Reader::view() const
+{
+        return GraphView(_version->names, _version->out, _version->reverse(),
+                         _version->directed);
+}
+
+/**
+ * search
+ * Run `algorithm` on the pinned version. Every query has its own search
+ * state, the parallel searches run on the calling thread only, as the
+ * readers are the parallelism here.
+ */
+std::vector<int> ConcurrentGraph::Reader::search(int start, int goal,
+                                                 PathAlgorithm algorithm)
+        const
+{
+        const CsrGraph& out = _version->out;
+        switch (algorithm) {
+        case PathAlgorithm::BidirectionalBfs: {
+                BidirectionalBfs<CsrGraph> engine(out, _version->reverse());
+                return engine.run(start, goal);
+        }
+        case PathAlgorithm::Dijkstra:
+        case PathAlgorithm::DeltaStepping:
+        case PathAlgorithm::Landmarks: {
+                const LandmarkIndex* landmarks =
+                        algorithm == PathAlgorithm::Landmarks &&
+                        !_version->landmarks.empty() ?
+                        &_version->landmarks : nullptr;
+                Dijkstra engine(out);
+                engine.run(start, goal, landmarks);
+                return engine.path(goal);
+        }
+        default: {
+                BfsEngine<CsrGraph> engine(out, _version->reverse());
+                engine.run(start, goal);
+                return engine.path(goal);
+        }
+        }
+}
+
+std::vector<std::string> ConcurrentGraph::Reader::get_shortest_path(
+        const std::string& point_a, const std::string& point_b,
+        PathAlgorithm algorithm) const
+{
+        std::vector<std::string> vertex_path;
+        int start = find(point_a);
+        int goal = find(point_b);
+        if (start < 0 || goal < 0)
+                return vertex_path;
+
+        for (auto& vertex : search(start, goal, algorithm)) {
+                vertex_path.push_back(_version->names.name(vertex));
+        }
+        return vertex_path;
+}
+
+/**
+ * get_shortest_distance
+ * Sum of the arc weights along the shortest path found by `algorithm`,
+ * infinity when there is no path.
+ */
+double ConcurrentGraph::Reader::get_shortest_distance(
+        const std::string& point_a, const std::string& point_b,
+        PathAlgorithm algorithm) const
+{
+        int start = find(point_a);
+        int goal = find(point_b);
+        if (start < 0 || goal < 0)
+                return std::numeric_limits<double>::infinity();
+        std::vector<int> path = search(start, goal, algorithm);
+        if (path.empty())
+                return std::numeric_limits<double>::infinity();
+
+        const CsrGraph& out = _version->out;
+        double length = 0;
+        for (std::size_t index = 1 ; index < path.size() ; index++) {
+                const int* adj = std::lower_bound(out.begin(path[index - 1]),
+                                                  out.end(path[index - 1]),
+                                                  path[index]);
+                length += out.weight(adj);
+        }
+        return length;
+}
+} /* namespace ascii_graph */
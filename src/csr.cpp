@@ -0,0 +1,404 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include "csr.h"
+
+namespace ascii_graph {
+int CsrBuilder::add_vertex()
+{
+        _lists.push_back(std::vector<int>());
+        if (_weighted)
+                _weights.push_back(std::vector<float>());
+        return static_cast<int>(_lists.size() - 1);
+}
+
+/* Add `count` vertices at once, returns the index of the first one */
+int CsrBuilder::add_vertices(int count)
+{
+        int first = vertices();
+        _lists.resize(first + count);
+        if (_weighted)
+                _weights.resize(first + count);
+        return first;
+}
+
+/**
+ * reserve
+ * Size the storage for `vertices` vertices and `arcs` bulk arcs in total,
+ * so that loading them doesn't reallocate.
+ */
+void CsrBuilder::reserve(int vertices, std::size_t arcs)
+{
+        _lists.reserve(vertices);
+        if (_weighted)
+                _weights.reserve(vertices);
+        _bulk.reserve(arcs);
+}
+
+/* Store weights for the arcs added one at a time, they weigh 1 so far */
+void CsrBuilder::make_weighted()
+{
+        _weights.resize(_lists.size());
+        for (std::size_t vertex = 0 ; vertex < _lists.size() ; vertex++) {
+                _weights[vertex].assign(_lists[vertex].size(), 1);
+        }
+        _weighted = true;
+}
+
+void CsrBuilder::add_arc(int from, int to)
+{
+        _lists[from].push_back(to);
+        if (_weighted)
+                _weights[from].push_back(1);
+}
+
+void CsrBuilder::add_arc(int from, int to, float weight)
+{
+        if (weight != 1 && !_weighted)
+                make_weighted();
+        _lists[from].push_back(to);
+        if (_weighted)
+                _weights[from].push_back(weight);
+}
+
+/**
+ * add_arcs
+ * Append the arcs `first` .. `last - 1` in bulk, `symmetric` adds the
+ * reverse of every arc as well.
+ */
+void CsrBuilder::add_arcs(const Arc* first, const Arc* last, bool symmetric)
+{
+        for (const Arc* arc = first ; arc != last ; ++arc) {
+                if (arc->weight != 1 && !_weighted)
+                        make_weighted();
+                _bulk.push_back(*arc);
+                if (symmetric && arc->from != arc->to) {
+                        Arc reverse = { arc->to, arc->from, arc->weight };
+                        _bulk.push_back(reverse);
+                }
+        }
+}
+
+/**
+ * remove_arc
+ * Remove every copy of the arc from `from` to `to` from the lists.
+ * Returns the number of removed copies.
+ */
+int CsrBuilder::remove_arc(int from, int to)
+{
+        std::vector<int>& list = _lists[from];
+        std::size_t kept = 0;
+        for (std::size_t index = 0 ; index < list.size() ; index++) {
+                if (list[index] == to)
+                        continue;
+                if (_weighted)
+                        _weights[from][kept] = _weights[from][index];
+                list[kept++] = list[index];
+        }
+        int removed = static_cast<int>(list.size() - kept);
+        list.resize(kept);
+        if (_weighted)
+                _weights[from].resize(kept);
+        return removed;
+}
+
+void CsrBuilder::clear_arcs(int vertex)
+{
+        std::vector<int>().swap(_lists[vertex]);
+        if (_weighted)
+                std::vector<float>().swap(_weights[vertex]);
+}
+
+/**
+ * remove_arcs_to
+ * Remove the arcs leading to the vertices flagged in `removed`, a sweep
+ * over all lists.
+ */
+void CsrBuilder::remove_arcs_to(const std::vector<char>& removed)
+{
+        for (std::size_t vertex = 0 ; vertex < _lists.size() ; vertex++) {
+                std::vector<int>& list = _lists[vertex];
+                std::size_t kept = 0;
+                for (std::size_t index = 0 ; index < list.size() ; index++) {
+                        if (removed[list[index]])
+                                continue;
+                        if (_weighted)
+                                _weights[vertex][kept] =
+                                        _weights[vertex][index];
+                        list[kept++] = list[index];
+                }
+                list.resize(kept);
+                if (_weighted)
+                        _weights[vertex].resize(kept);
+        }
+}
+
+/**
+ * compact
+ * Renumber vertex v to mapping[v] and drop the vertices mapped to -1
+ * together with the arcs leading to them, `count` vertices are left.
+ */
+void CsrBuilder::compact(const std::vector<int>& mapping, int count)
+{
+        for (std::size_t vertex = 0 ; vertex < _lists.size() ; vertex++) {
+                int target = mapping[vertex];
+                if (target < 0)
+                        continue;
+                std::vector<int>& list = _lists[vertex];
+                std::size_t kept = 0;
+                for (std::size_t index = 0 ; index < list.size() ; index++) {
+                        if (mapping[list[index]] < 0)
+                                continue;
+                        if (_weighted)
+                                _weights[vertex][kept] =
+                                        _weights[vertex][index];
+                        list[kept++] = mapping[list[index]];
+                }
+                list.resize(kept);
+                /* the targets never move up, so the lists move down in
+                 * place */
+                _lists[target].swap(list);
+                if (_weighted) {
+                        _weights[vertex].resize(kept);
+                        _weights[target].swap(_weights[vertex]);
+                }
+        }
+        _lists.resize(count);
+        if (_weighted)
+                _weights.resize(count);
+}
+
+/**
+ * freeze
+ * Move the arcs of the builder into the CSR arrays.
+ *
+ * The arrays are sized once from the number of arcs per vertex, then every
+ * list and bulk arc is copied into place, a counting sort by source. The
+ * arcs of every vertex are sorted and deduplicated on the way, of parallel
+ * weighted arcs the lightest one is kept. The builder is empty afterwards.
+ */
+void CsrGraph::freeze(CsrBuilder& builder)
+{
+        std::size_t count = builder._lists.size();
+        bool weighted = builder._weighted;
+        _offsets.assign(count + 1, 0);
+        for (std::size_t vertex = 0 ; vertex < count ; vertex++) {
+                _offsets[vertex + 1] = builder._lists[vertex].size();
+        }
+        for (auto& arc : builder._bulk) {
+                _offsets[arc.from + 1]++;
+        }
+        for (std::size_t vertex = 0 ; vertex < count ; vertex++) {
+                _offsets[vertex + 1] += _offsets[vertex];
+        }
+        _targets.resize(_offsets[count]);
+        _weights.resize(weighted ? _offsets[count] : 0);
+
+        std::vector<int> next(_offsets.begin(), _offsets.end() - 1);
+        for (std::size_t vertex = 0 ; vertex < count ; vertex++) {
+                std::vector<int>& list = builder._lists[vertex];
+                std::copy(list.begin(), list.end(),
+                          _targets.begin() + next[vertex]);
+                if (weighted)
+                        std::copy(builder._weights[vertex].begin(),
+                                  builder._weights[vertex].end(),
+                                  _weights.begin() + next[vertex]);
+                next[vertex] += static_cast<int>(list.size());
+                /* release the lists early, they are as large as the CSR */
+                std::vector<int>().swap(list);
+                if (weighted)
+                        std::vector<float>().swap(builder._weights[vertex]);
+        }
+        for (auto& arc : builder._bulk) {
+                if (weighted)
+                        _weights[next[arc.from]] = arc.weight;
+                _targets[next[arc.from]++] = arc.to;
+        }
+        builder.clear();
+
+        /* sort the arcs of every vertex, the duplicates are dropped by
+         * moving the following arcs down over them */
+        int write = 0;
+        std::vector< std::pair<int, float> > arcs;
+        for (std::size_t vertex = 0 ; vertex < count ; vertex++) {
+                int first = _offsets[vertex];
+                int last = _offsets[vertex + 1];
+                _offsets[vertex] = write;
+                if (!weighted) {
+                        std::sort(_targets.begin() + first,
+                                  _targets.begin() + last);
+                        for (int arc = first ; arc < last ; arc++) {
+                                if (write > _offsets[vertex] &&
+                                    _targets[write - 1] == _targets[arc])
+                                        continue;
+                                _targets[write++] = _targets[arc];
+                        }
+                        continue;
+                }
+                arcs.clear();
+                for (int arc = first ; arc < last ; arc++) {
+                        arcs.push_back(std::make_pair(_targets[arc],
+                                                      _weights[arc]));
+                }
+                /* sorted by weight within a target, the first one stays */
+                std::sort(arcs.begin(), arcs.end());
+                for (auto& arc : arcs) {
+                        if (write > _offsets[vertex] &&
+                            _targets[write - 1] == arc.first)
+                                continue;
+                        _targets[write] = arc.first;
+                        _weights[write++] = arc.second;
+                }
+        }
+        _offsets[count] = write;
+        if (static_cast<std::size_t>(write) < _targets.size()) {
+                _targets.resize(write);
+                _targets.shrink_to_fit();
+                if (weighted) {
+                        _weights.resize(write);
+                        _weights.shrink_to_fit();
+                }
+        }
+        _attached = false;
+        view();
+}
+
+/**
+ * thaw
+ * Turn the CSR arrays back into growable adjacency lists.
+ *
+ * Used when a frozen graph is modified again, the CSR arrays are released.
+ */
+void CsrGraph::thaw(CsrBuilder& builder)
+{
+        int count = vertices();
+        builder.clear();
+        builder._lists.assign(count, std::vector<int>());
+        for (int vertex = 0 ; vertex < count ; vertex++) {
+                builder._lists[vertex].assign(begin(vertex), end(vertex));
+        }
+        if (weighted()) {
+                builder._weighted = true;
+                builder._weights.assign(count, std::vector<float>());
+                for (int vertex = 0 ; vertex < count ; vertex++) {
+                        builder._weights[vertex].assign(
+                                _weight_data + _offset_data[vertex],
+                                _weight_data + _offset_data[vertex + 1]);
+                }
+        }
+        std::vector<int>().swap(_offsets);
+        std::vector<int>().swap(_targets);
+        std::vector<float>().swap(_weights);
+        _attached = false;
+        view();
+}
+
+/**
+ * transpose
+ * Store the reverse of every arc of `graph`, so that the arcs of a vertex
+ * are the ones entering it in `graph`.
+ *
+ * A counting sort over the targets, the sources are visited in ascending
+ * order and so the lists come out sorted.
+ */
+void CsrGraph::transpose(const CsrGraph& graph)
+{
+        int count = graph.vertices();
+        _offsets.assign(count + 1, 0);
+        _targets.resize(graph.arcs());
+        _weights.resize(graph.weighted() ? graph.arcs() : 0);
+        for (int arc = 0 ; arc < graph.arcs() ; arc++) {
+                _offsets[graph._target_data[arc] + 1]++;
+        }
+        for (int vertex = 0 ; vertex < count ; vertex++) {
+                _offsets[vertex + 1] += _offsets[vertex];
+        }
+        std::vector<int> next(_offsets.begin(), _offsets.end() - 1);
+        for (int vertex = 0 ; vertex < count ; vertex++) {
+                graph.for_each_weighted(vertex, [&](int adj, float weight) {
+                        if (!_weights.empty())
+                                _weights[next[adj]] = weight;
+                        _targets[next[adj]++] = vertex;
+                });
+        }
+        _attached = false;
+        view();
+}
+
+/**
+ * attach
+ * Use the arrays of a mapped snapshot, `offsets` holds `vertices + 1`
+ * entries and `weights` is null for an unweighted graph. They have to
+ * outlive the graph or the next thaw().
+ */
+void CsrGraph::attach(const int* offsets, const int* targets,
+                      const float* weights, int vertices)
+{
+        std::vector<int>().swap(_offsets);
+        std::vector<int>().swap(_targets);
+        std::vector<float>().swap(_weights);
+        _offset_data = offsets;
+        _target_data = targets;
+        _weight_data = weights;
+        _vertices = vertices;
+        _attached = true;
+}
+
+CsrGraph::CsrGraph(const CsrGraph& other)
+        : _offsets(other._offsets), _targets(other._targets),
+          _weights(other._weights)
+{
+        if (other._attached)
+                attach(other._offset_data, other._target_data,
+                       other._weight_data, other._vertices);
+        else
+                view();
+}
+
+CsrGraph& CsrGraph::operator=(const CsrGraph& other)
+{
+        if (this == &other)
+                return *this;
+        _offsets = other._offsets;
+        _targets = other._targets;
+        _weights = other._weights;
+        if (other._attached) {
+                attach(other._offset_data, other._target_data,
+                       other._weight_data, other._vertices);
+        } else {
+                _attached = false;
+                view();
+        }
+        return *this;
+}
+
+/* point the arrays in use at the own vectors */
+void CsrGraph::view()
+{
+        _offset_data = _offsets.data();
+        _target_data = _targets.data();
+        _weight_data = _weights.empty() ? nullptr : _weights.data();
+        _vertices = _offsets.empty() ? 0 :
+                static_cast<int>(_offsets.size() - 1);
+}
+
+bool CsrGraph::has_arc(int from, int to) const
+{
+        return std::binary_search(begin(from), end(from), to);
+}
+} /* namespace ascii_graph */
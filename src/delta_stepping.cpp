@@ -0,0 +1,199 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <thread>
+#include "delta_stepping.h"
+#include "barrier.h"
+#include "parallel_bfs.h"
+
+namespace ascii_graph {
+/* Number of frontier vertices handed out at once */
+static const long chunk_size = 64;
+/* Marks a vertex that isn't in the settled list of any bucket */
+static const std::size_t no_bucket = static_cast<std::size_t>(-1);
+
+DeltaStepping::DeltaStepping(const CsrGraph& out, int threads)
+        : _out(out), _count(out.vertices()),
+          _threads(threads > 0 ? threads : default_thread_count())
+{
+}
+
+/**
+ * relax
+ * Turn the arcs of the claimed frontier chunks into requests, only the
+ * light or only the heavy arcs depending on the phase.
+ */
+void DeltaStepping::relax(int worker)
+{
+        std::vector<Request>& requests = _requests[worker];
+        long size = static_cast<long>(_frontier.size());
+        requests.clear();
+        for (;;) {
+                long chunk = _next_chunk.fetch_add(1,
+                                                   std::memory_order_relaxed);
+                if (chunk * chunk_size >= size)
+                        break;
+                long end = std::min(size, (chunk + 1) * chunk_size);
+                for (long index = chunk * chunk_size ; index < end ; index++) {
+                        int vertex = _frontier[index];
+                        double base = _distance[vertex];
+                        _out.for_each_weighted(vertex, [&](int adj,
+                                                           float weight) {
+                                if ((weight <= _delta) != _light)
+                                        return;
+                                double candidate = base + weight;
+                                if (candidate >= _distance[adj])
+                                        return;
+                                Request request = { adj, vertex, candidate };
+                                requests.push_back(request);
+                        });
+                }
+        }
+}
+
+/* Lower the distances for all requests and move the vertices to their
+ * new buckets */
+void DeltaStepping::apply()
+{
+        for (auto& requests : _requests) {
+                for (auto& request : requests) {
+                        if (request.distance >= _distance[request.vertex])
+                                continue;
+                        _distance[request.vertex] = request.distance;
+                        _parent[request.vertex] = request.parent;
+                        std::size_t index = bucket(request.distance);
+                        if (index >= _buckets.size())
+                                _buckets.resize(index + 1);
+                        _buckets[index].push_back(request.vertex);
+                }
+        }
+}
+
+/**
+ * prepare
+ * Select the vertices of the next phase. Returns false once all buckets
+ * are empty, or once the distance of `goal` can't change anymore.
+ */
+bool DeltaStepping::prepare(int goal)
+{
+        for (;;) {
+                _frontier.clear();
+                if (_current < _buckets.size()) {
+                        std::vector<int>& current = _buckets[_current];
+                        for (auto& vertex : current) {
+                                double distance = _distance[vertex];
+                                /* moved to a lower bucket, or a duplicate */
+                                if (bucket(distance) != _current ||
+                                    _expanded[vertex] == distance)
+                                        continue;
+                                _expanded[vertex] = distance;
+                                _frontier.push_back(vertex);
+                                if (_settled_in[vertex] != _current) {
+                                        _settled_in[vertex] = _current;
+                                        _settled.push_back(vertex);
+                                }
+                        }
+                        current.clear();
+                }
+                _next_chunk.store(0);
+                if (!_frontier.empty()) {
+                        _light = true;
+                        return true;
+                }
+                if (!_settled.empty()) {
+                        _frontier.swap(_settled);
+                        _light = false;
+                        return true;
+                }
+
+                /* the distances below the next bucket are final */
+                _current++;
+                if (goal >= 0 && reached(goal) &&
+                    bucket(_distance[goal]) < _current)
+                        return false;
+                while (_current < _buckets.size() &&
+                       _buckets[_current].empty()) {
+                        _current++;
+                }
+                if (_current >= _buckets.size())
+                        return false;
+        }
+}
+
+/**
+ * run
+ * Compute the distances from `source`, stopping early once the distance
+ * of `goal` is final when `goal` isn't -1.
+ */
+void DeltaStepping::run(int source, int goal)
+{
+        if (_delta <= 0) {
+                double total = 0;
+                for (int arc = 0 ; arc < _out.arcs() ; arc++) {
+                        total += _out.weight(_out.targets() + arc);
+                }
+                _delta = _out.arcs() && total > 0 ? total / _out.arcs() : 1;
+        }
+        _distance.assign(_count, std::numeric_limits<double>::infinity());
+        _parent.assign(_count, -1);
+        _expanded.assign(_count, -1);
+        _settled_in.assign(_count, no_bucket);
+        _settled.clear();
+        _buckets.assign(1, std::vector<int>(1, source));
+        _requests.assign(_threads, std::vector<Request>());
+        _distance[source] = 0;
+        _current = 0;
+
+        bool done = !prepare(goal);
+        Barrier barrier(_threads);
+        auto work = [&](int worker) {
+                for (;;) {
+                        barrier.wait();
+                        if (done)
+                                break;
+                        relax(worker);
+                        barrier.wait();
+                        if (worker != 0)
+                                continue;
+                        apply();
+                        done = !prepare(goal);
+                }
+        };
+
+        std::vector<std::thread> workers;
+        for (int worker = 1 ; worker < _threads ; worker++) {
+                workers.push_back(std::thread(work, worker));
+        }
+        work(0);
+        for (auto& thread : workers) {
+                thread.join();
+        }
+}
+
+std::vector<int> DeltaStepping::path(int goal) const
+{
+        std::vector<int> result;
+        if (goal < 0 || !reached(goal))
+                return result;
+        for (int next = goal ; next >= 0 ; next = _parent[next]) {
+                result.push_back(next);
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+}
+} /* namespace ascii_graph */
@@ -0,0 +1,175 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include "dijkstra.h"
+
+namespace ascii_graph {
+Dijkstra::Dijkstra(const CsrGraph& out) : _out(out), _count(out.vertices())
+{
+}
+
+void Dijkstra::place(std::size_t index, const Entry& entry)
+{
+        _heap[index] = entry;
+        _position[entry.vertex] = static_cast<int>(index);
+}
+
+void Dijkstra::sift_up(std::size_t index)
+{
+        Entry entry = _heap[index];
+        while (index > 0) {
+                std::size_t parent = (index - 1) / arity;
+                if (_heap[parent].distance <= entry.distance)
+                        break;
+                place(index, _heap[parent]);
+                index = parent;
+        }
+        place(index, entry);
+}
+
+void Dijkstra::sift_down(std::size_t index)
+{
+        Entry entry = _heap[index];
+        std::size_t size = _heap.size();
+        for (;;) {
+                std::size_t first = index * arity + 1;
+                if (first >= size)
+                        break;
+                std::size_t last = std::min(first + arity, size);
+                std::size_t best = first;
+                for (std::size_t child = first + 1 ; child < last ;
+                     child++) {
+                        if (_heap[child].distance < _heap[best].distance)
+                                best = child;
+                }
+                if (entry.distance <= _heap[best].distance)
+                        break;
+                place(index, _heap[best]);
+                index = best;
+        }
+        place(index, entry);
+}
+
+/* Queue `vertex`, or move it up if it is queued with a larger key */
+void Dijkstra::push(int vertex, double key)
+{
+        Entry entry = { key, vertex };
+        if (_position[vertex] < 0) {
+                _heap.push_back(entry);
+                sift_up(_heap.size() - 1);
+                return;
+        }
+        _heap[_position[vertex]].distance = key;
+        sift_up(_position[vertex]);
+}
+
+/* Clear the results of the last run */
+void Dijkstra::reset()
+{
+        if (_distance.empty()) {
+                _distance.assign(_count,
+                                 std::numeric_limits<double>::infinity());
+                _parent.assign(_count, -1);
+                _position.assign(_count, -1);
+        }
+        for (auto& vertex : _touched) {
+                _distance[vertex] = std::numeric_limits<double>::infinity();
+                _parent[vertex] = -1;
+        }
+        for (auto& entry : _heap) {
+                _position[entry.vertex] = -1;
+        }
+        _touched.clear();
+        _heap.clear();
+        _settled = 0;
+}
+
+int Dijkstra::pop()
+{
+        int vertex = _heap.front().vertex;
+        _position[vertex] = -1;
+        Entry last = _heap.back();
+        _heap.pop_back();
+        if (!_heap.empty()) {
+                place(0, last);
+                sift_down(0);
+        }
+        return vertex;
+}
+
+/**
+ * run
+ * Settle vertices in the order of their distance from `source`, until
+ * `goal` is settled or, with a `goal` of -1, every reachable vertex is.
+ * A `potential` guides the search towards `goal`.
+ */
+void Dijkstra::run(int source, int goal, const Potential* potential)
+{
+        reset();
+        if (potential && goal >= 0 &&
+            potential->bound(source, goal) ==
+            std::numeric_limits<double>::infinity())
+                return;
+
+        _distance[source] = 0;
+        _touched.push_back(source);
+        push(source, 0);
+        while (!_heap.empty()) {
+                int vertex = pop();
+                _settled++;
+                if (vertex == goal)
+                        break;
+                double base = _distance[vertex];
+                _out.for_each_weighted(vertex, [&](int adj, float weight) {
+                        double candidate = base + weight;
+                        if (candidate >= _distance[adj])
+                                return;
+                        double key = candidate;
+                        if (potential && goal >= 0) {
+                                key += potential->bound(adj, goal);
+                                if (key == std::numeric_limits<double>::
+                                    infinity())
+                                        return;
+                        }
+                        if (_distance[adj] ==
+                            std::numeric_limits<double>::infinity())
+                                _touched.push_back(adj);
+                        _distance[adj] = candidate;
+                        _parent[adj] = vertex;
+                        push(adj, key);
+                });
+        }
+}
+
+/**
+ * path
+ * Walk the parent array from `goal` back to the source.
+ * Returns an empty path when `goal` wasn't reached.
+ */
+std::vector<int> Dijkstra::path(int goal) const
+{
+        std::vector<int> result;
+        if (goal < 0 || !reached(goal))
+                return result;
+        for (int next = goal ; next >= 0 ; next = _parent[next]) {
+                result.push_back(next);
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+}
+} /* namespace ascii_graph */
@@ -0,0 +1,297 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cctype>
+#include "dot_lexer.h"
+
+namespace ascii_graph {
+static bool is_id_start(char c)
+{
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_' ||
+                (static_cast<unsigned char>(c) & 0x80);
+}
+
+static bool is_id_char(char c)
+{
+        return is_id_start(c) || std::isdigit(static_cast<unsigned char>(c));
+}
+
+static bool is_digit(char c)
+{
+        return std::isdigit(static_cast<unsigned char>(c));
+}
+
+/**
+ * token_is_keyword
+ * Compare an unquoted identifier case-insensitively with `keyword`.
+ */
+bool token_is_keyword(const Token& token, const char* keyword)
+{
+        if (token.type != TokenType::Identifier || token.quoted)
+                return false;
+        std::size_t index = 0;
+        for ( ; index < token.length ; index++) {
+                if (!keyword[index] ||
+                    std::tolower(static_cast<unsigned char>(
+                                 token.text[index])) != keyword[index])
+                        return false;
+        }
+        return keyword[index] == '\0';
+}
+
+/**
+ * scan
+ * Continue scanning `buffer` where the last call stopped. Returns the
+ * offset behind the last safe cut found so far, 0 if there is none.
+ */
+std::size_t StatementSplitter::scan(const char* buffer, std::size_t size)
+{
+        for ( ; _position < size ; _position++) {
+                char c = buffer[_position];
+                char previous = _previous;
+                bool line_start = _line_start;
+                _previous = c;
+                if (c == '\n')
+                        _line_start = true;
+                else if (!std::isspace(static_cast<unsigned char>(c)))
+                        _line_start = false;
+                switch (_state) {
+                case State::Quoted:
+                        if (c == '\\' && previous == '\\')
+                                _previous = '\0';
+                        else if (c == '"' && previous != '\\')
+                                _state = State::Code;
+                        continue;
+                case State::Html:
+                        if (c == '<')
+                                _html_depth++;
+                        else if (c == '>' && --_html_depth == 0)
+                                _state = State::Code;
+                        continue;
+                case State::LineComment:
+                        if (c == '\n')
+                                _state = State::Code;
+                        continue;
+                case State::BlockComment:
+                        if (c == '/' && previous == '*')
+                                _state = State::Code;
+                        continue;
+                case State::Code:
+                        break;
+                }
+
+                if (c == '"') {
+                        _state = State::Quoted;
+                } else if (c == '<') {
+                        _state = State::Html;
+                        _html_depth = 1;
+                } else if (c == '#' && line_start) {
+                        _state = State::LineComment;
+                } else if (c == '/' && previous == '/') {
+                        _state = State::LineComment;
+                } else if (c == '*' && previous == '/') {
+                        _state = State::BlockComment;
+                        /* the '*' can't also close the comment */
+                        _previous = '\0';
+                } else if (c == '{') {
+                        if (++_depth == 1)
+                                _boundary = _position + 1;
+                } else if (c == '}') {
+                        _depth--;
+                } else if (c == '[') {
+                        _bracket_depth++;
+                } else if (c == ']') {
+                        _bracket_depth--;
+                } else if (c == ';' && _depth == 1 && _bracket_depth == 0) {
+                        _boundary = _position + 1;
+                }
+        }
+        return _boundary;
+}
+
+/**
+ * consumed
+ * The first `count` bytes (at most the last returned cut) were removed from
+ * the front of the buffer.
+ */
+void StatementSplitter::consumed(std::size_t count)
+{
+        _position -= count;
+        _boundary -= count;
+}
+
+Token DotLexer::make(TokenType type, const char* text, std::size_t length)
+{
+        Token token = { type, text, length, false, _line };
+        return token;
+}
+
+/**
+ * skip_ignored
+ * Move the cursor to the start of the next token.
+ */
+void DotLexer::skip_ignored()
+{
+        while (_cursor != _end) {
+                char c = *_cursor;
+                if (c == '\n') {
+                        _line++;
+                        _line_start = true;
+                        _cursor++;
+                } else if (std::isspace(static_cast<unsigned char>(c))) {
+                        _cursor++;
+                } else if (c == '#' && _line_start) {
+                        while (_cursor != _end && *_cursor != '\n')
+                                _cursor++;
+                } else if (c == '/' && _end - _cursor > 1 &&
+                           _cursor[1] == '/') {
+                        while (_cursor != _end && *_cursor != '\n')
+                                _cursor++;
+                } else if (c == '/' && _end - _cursor > 1 &&
+                           _cursor[1] == '*') {
+                        _cursor += 2;
+                        while (_cursor != _end &&
+                               !(*_cursor == '*' && _end - _cursor > 1 &&
+                                 _cursor[1] == '/')) {
+                                if (*_cursor == '\n')
+                                        _line++;
+                                _cursor++;
+                        }
+                        _cursor = _cursor == _end ? _end : _cursor + 2;
+                } else {
+                        return;
+                }
+        }
+}
+
+Token DotLexer::identifier()
+{
+        const char* start = _cursor;
+        while (_cursor != _end && is_id_char(*_cursor))
+                _cursor++;
+        return make(TokenType::Identifier, start, _cursor - start);
+}
+
+/* [-]?(.[0-9]+ | [0-9]+(.[0-9]*)?) */
+Token DotLexer::numeral()
+{
+        const char* start = _cursor;
+        if (*_cursor == '-')
+                _cursor++;
+        while (_cursor != _end && is_digit(*_cursor))
+                _cursor++;
+        if (_cursor != _end && *_cursor == '.') {
+                _cursor++;
+                while (_cursor != _end && is_digit(*_cursor))
+                        _cursor++;
+        }
+        return make(TokenType::Identifier, start, _cursor - start);
+}
+
+Token DotLexer::quoted_string()
+{
+        const char* start = ++_cursor;
+        int line = _line;
+        while (_cursor != _end && *_cursor != '"') {
+                if (*_cursor == '\\' && _end - _cursor > 1)
+                        _cursor++;
+                if (*_cursor == '\n')
+                        _line++;
+                _cursor++;
+        }
+        if (_cursor == _end)
+                return make(TokenType::Error, start - 1, _end - start + 1);
+        Token token = { TokenType::Identifier, start,
+                        static_cast<std::size_t>(_cursor - start), true, line };
+        _cursor++;
+        return token;
+}
+
+Token DotLexer::html_string()
+{
+        const char* start = ++_cursor;
+        int line = _line;
+        int depth = 1;
+        while (_cursor != _end) {
+                if (*_cursor == '<')
+                        depth++;
+                else if (*_cursor == '>' && --depth == 0)
+                        break;
+                else if (*_cursor == '\n')
+                        _line++;
+                _cursor++;
+        }
+        if (_cursor == _end)
+                return make(TokenType::Error, start - 1, _end - start + 1);
+        Token token = { TokenType::Identifier, start,
+                        static_cast<std::size_t>(_cursor - start), true, line };
+        _cursor++;
+        return token;
+}
+
+Token DotLexer::next()
+{
+        skip_ignored();
+        if (_cursor == _end)
+                return make(TokenType::End, _cursor, 0);
+        _line_start = false;
+
+        char c = *_cursor;
+        bool has_next = _end - _cursor > 1;
+        switch (c) {
+        case '{':
+                return make(TokenType::LeftBrace, _cursor++, 1);
+        case '}':
+                return make(TokenType::RightBrace, _cursor++, 1);
+        case '[':
+                return make(TokenType::LeftBracket, _cursor++, 1);
+        case ']':
+                return make(TokenType::RightBracket, _cursor++, 1);
+        case ';':
+                return make(TokenType::Semicolon, _cursor++, 1);
+        case ',':
+                return make(TokenType::Comma, _cursor++, 1);
+        case '=':
+                return make(TokenType::Equals, _cursor++, 1);
+        case ':':
+                return make(TokenType::Colon, _cursor++, 1);
+        case '"':
+                return quoted_string();
+        case '<':
+                return html_string();
+        case '-':
+                if (has_next && _cursor[1] == '-') {
+                        _cursor += 2;
+                        return make(TokenType::UndirectedEdge, _cursor - 2, 2);
+                }
+                if (has_next && _cursor[1] == '>') {
+                        _cursor += 2;
+                        return make(TokenType::DirectedEdge, _cursor - 2, 2);
+                }
+                if (has_next && (is_digit(_cursor[1]) || _cursor[1] == '.'))
+                        return numeral();
+                break;
+        default:
+                if (is_id_start(c))
+                        return identifier();
+                if (is_digit(c) || (c == '.' && has_next &&
+                                    is_digit(_cursor[1])))
+                        return numeral();
+        }
+        return make(TokenType::Error, _cursor, 1);
+}
+} /* namespace ascii_graph */
@@ -0,0 +1,121 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <thread>
+#include "epoch.h"
+
+namespace ascii_graph {
+/* Epoch of a slot without a reader, the epochs start at 1 */
+static const unsigned long idle = 0;
+
+EpochDomain::EpochDomain() : _epoch(1)
+{
+        for (auto& slot : _slots) {
+                slot.epoch.store(idle);
+        }
+}
+
+EpochDomain::~EpochDomain()
+{
+        for (auto& retired : _retired) {
+                retired.second();
+        }
+}
+
+/**
+ * enter
+ * Announce the current epoch in a free slot, starting the search at a
+ * slot picked by the thread to keep the readers apart.
+ * Returns the slot, to be passed to leave().
+ */
+int EpochDomain::enter()
+{
+        int start = static_cast<int>(
+                std::hash<std::thread::id>()(std::this_thread::get_id()) %
+                slot_count);
+        for ( ; ; ) {
+                unsigned long epoch = _epoch.load();
+                for (int offset = 0 ; offset < slot_count ; offset++) {
+                        int slot = (start + offset) % slot_count;
+                        unsigned long expected = idle;
+                        if (_slots[slot].epoch.load(
+                                std::memory_order_relaxed) == idle &&
+                            _slots[slot].epoch.compare_exchange_strong(
+                                expected, epoch))
+                                return slot;
+                }
+                std::this_thread::yield();
+        }
+}
+
+void EpochDomain::leave(int slot)
+{
+        _slots[slot].epoch.store(idle, std::memory_order_release);
+}
+
+/**
+ * retire
+ * Stamp an object with the current epoch and advance the epoch. The
+ * object has to be unreachable for readers entering from now on.
+ */
+void EpochDomain::retire(std::function<void()> reclaim)
+{
+        std::lock_guard<std::mutex> lock(_retired_lock);
+        unsigned long epoch = _epoch.fetch_add(1);
+        _retired.push_back(std::make_pair(epoch, std::move(reclaim)));
+}
+
+/**
+ * collect
+ * Free the objects retired before the oldest epoch any reader announced,
+ * all of them without readers.
+ */
+void EpochDomain::collect()
+{
+        unsigned long oldest = _epoch.load();
+        for (auto& slot : _slots) {
+                unsigned long epoch = slot.epoch.load();
+                if (epoch != idle)
+                        oldest = std::min(oldest, epoch);
+        }
+
+        std::vector<std::function<void()> > ready;
+        {
+                std::lock_guard<std::mutex> lock(_retired_lock);
+                auto safe = std::stable_partition(
+                        _retired.begin(), _retired.end(),
+                        [&](const std::pair<unsigned long,
+                                            std::function<void()> >& retired) {
+                        return retired.first >= oldest;
+                });
+                for (auto entry = safe ; entry != _retired.end() ; ++entry) {
+                        ready.push_back(std::move(entry->second));
+                }
+                _retired.erase(safe, _retired.end());
+        }
+        for (auto& reclaim : ready) {
+                reclaim();
+        }
+}
+
+std::size_t EpochDomain::pending()
+{
+        std::lock_guard<std::mutex> lock(_retired_lock);
+        return _retired.size();
+}
+} /* namespace ascii_graph */
@@ -15,176 +15,1342 @@
  * You should have received a copy of the GNU Affero General Public License
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
+#include <cctype>
 #include <set>
 #include <tuple>
 #include <queue>
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include "graph.h"
+#include "bfs.h"
+#include "parallel_bfs.h"
+#include "multi_source_bfs.h"
+#include "dijkstra.h"
+#include "delta_stepping.h"
 #include "print_coordinates.h"
 
 using namespace ascii_graph;
 
+/* Fill `text` up to `width` characters with spaces */
+static std::string pad(const std::string& text, int width)
+{
+        std::string padded = text;
+        padded.resize(std::max(padded.size(),
+                               static_cast<std::size_t>(width)), ' ');
+        return padded;
+}
+
+/**
+ * batch_distances
+ * Hop distances from each of `sources` to every vertex, computed by the
+ * bit-parallel search 64 sources at a time.
+ */
+template <typename Adjacency>
+static std::vector< std::vector<int> > batch_distances(
+        const Adjacency& adjacency, const Adjacency& reverse,
+        const std::vector<int>& sources)
+{
+        const std::size_t lanes = MultiSourceBfs<Adjacency>::lanes;
+        std::vector< std::vector<int> > distances(sources.size());
+        MultiSourceBfs<Adjacency> engine(adjacency, reverse);
+        int count = adjacency.vertices();
+
+        for (std::size_t first = 0 ; first < sources.size() ; first += lanes) {
+                std::size_t last = std::min(sources.size(), first + lanes);
+                engine.run(std::vector<int>(sources.begin() + first,
+                                            sources.begin() + last));
+                for (std::size_t index = first ; index < last ; index++) {
+                        std::vector<int>& row = distances[index];
+                        row.resize(count);
+                        for (int vertex = 0 ; vertex < count ; vertex++) {
+                                row[vertex] = engine.distance(index - first,
+                                                              vertex);
+                        }
+                }
+        }
+        return distances;
+}
+
+/**
+ * batch_paths
+ * Shortest paths for a list of (start, goal) index pairs. Every distinct
+ * start is searched once, 64 starts at a time.
+ */
+template <typename Adjacency>
+static std::vector< std::vector<int> > batch_paths(
+        const Adjacency& adjacency, const Adjacency& reverse,
+        const std::vector< std::pair<int, int> >& queries)
+{
+        const std::size_t lanes = MultiSourceBfs<Adjacency>::lanes;
+        std::vector< std::vector<int> > paths(queries.size());
+        std::vector<int> lane_of(adjacency.vertices(), -1);
+        std::vector<int> sources;
+        std::vector<std::size_t> slots(queries.size());
+
+        for (std::size_t index = 0 ; index < queries.size() ; index++) {
+                int start = queries[index].first;
+                if (lane_of[start] < 0) {
+                        lane_of[start] = static_cast<int>(sources.size());
+                        sources.push_back(start);
+                }
+                slots[index] = lane_of[start];
+        }
+
+        MultiSourceBfs<Adjacency> engine(adjacency, reverse);
+        for (std::size_t first = 0 ; first < sources.size() ; first += lanes) {
+                std::size_t last = std::min(sources.size(), first + lanes);
+                engine.run(std::vector<int>(sources.begin() + first,
+                                            sources.begin() + last));
+                for (std::size_t index = 0 ; index < queries.size() ;
+                     index++) {
+                        if (slots[index] < first || slots[index] >= last)
+                                continue;
+                        paths[index] = engine.path(slots[index] - first,
+                                                   queries[index].second);
+                }
+        }
+        return paths;
+}
+
 namespace ascii_graph {
-void Graph::create_vertex(char value)
+/**
+ * create_vertex
+ * Add a vertex called `name` and return its index. A name identifies a
+ * single vertex, the index of an existing vertex is returned as is and a
+ * removed one gets its index back.
+ */
+int Graph::create_vertex(const char* name, std::size_t length)
+{
+        int count = _names.size();
+        int index = _names.intern(name, length);
+        if (index == count) {
+                thaw();
+                _builder.add_vertex();
+                _version++;
+        } else if (removed(index)) {
+                revive(index);
+        }
+        return index;
+}
+
+/**
+ * link_two_vertices_undirected
+ * Connect two vertices in both directions. Returns -1 for an unknown
+ * vertex or a weight that is negative or not a number.
+ */
+int Graph::link_two_vertices_undirected(int vertex_one, int vertex_two,
+                                        float weight)
+{
+        int count = _names.size();
+        if (vertex_one < 0 || vertex_one >= count ||
+            vertex_two < 0 || vertex_two >= count || !(weight >= 0) ||
+            removed(vertex_one) || removed(vertex_two))
+                return -1;
+
+        thaw();
+        _builder.add_arc(vertex_one, vertex_two, weight);
+        if (vertex_one != vertex_two)
+                _builder.add_arc(vertex_two, vertex_one, weight);
+        _weighted = _weighted || weight != 1;
+        _version++;
+
+        return 0;
+}
+
+/**
+ * link_two_vertices_directed
+ * Add an arc leading from `from` to `to` only, which makes the graph
+ * directed.
+ */
+int Graph::link_two_vertices_directed(int from, int to, float weight)
+{
+        int count = _names.size();
+        if (from < 0 || from >= count || to < 0 || to >= count ||
+            !(weight >= 0) || removed(from) || removed(to))
+                return -1;
+
+        thaw();
+        _builder.add_arc(from, to, weight);
+        _directed = true;
+        _weighted = _weighted || weight != 1;
+        _version++;
+        return 0;
+}
+
+/**
+ * reserve
+ * Make room for `vertices` vertices and `edges` edges in total, the edges
+ * are counted once per direction for an undirected graph.
+ */
+void Graph::reserve(int vertices, std::size_t edges, bool directed)
+{
+        thaw();
+        _names.reserve(vertices, 0);
+        _builder.reserve(vertices, directed ? edges : 2 * edges);
+}
+
+/**
+ * add_vertices
+ * Create a vertex for every name that isn't known yet.
+ * Returns the vertex index of every name, in the same order.
+ */
+std::vector<int> Graph::add_vertices(const std::vector<std::string>& names)
+{
+        std::vector<int> indices;
+        int count = _names.size();
+        indices.reserve(names.size());
+        for (auto& name : names) {
+                indices.push_back(_names.intern(name.data(), name.size()));
+                if (removed(indices.back()))
+                        revive(indices.back());
+        }
+        if (_names.size() > count) {
+                thaw();
+                _builder.add_vertices(_names.size() - count);
+                _version++;
+        }
+        return indices;
+}
+
+/**
+ * add_edges
+ * Link all `edges` at once, in both directions unless `directed` is set.
+ * Returns -1 without adding any edge when one of them has an unknown
+ * vertex or an invalid weight, like the link functions.
+ */
+int Graph::add_edges(const std::vector<Arc>& edges, bool directed)
 {
-        _vertices.push_back(value);
-        _adj_matrix.resize(_vertices.size());
-        for (auto& row : _adj_matrix) {
-                row.resize(_vertices.size());
+        int count = _names.size();
+        bool weighted = false;
+        for (auto& edge : edges) {
+                if (edge.from < 0 || edge.from >= count ||
+                    edge.to < 0 || edge.to >= count || !(edge.weight >= 0) ||
+                    removed(edge.from) || removed(edge.to))
+                        return -1;
+                weighted = weighted || edge.weight != 1;
         }
+        if (edges.empty())
+                return 0;
+
+        thaw();
+        _builder.add_arcs(edges.data(), edges.data() + edges.size(),
+                          !directed);
+        _directed = _directed || directed;
+        _weighted = _weighted || weighted;
+        _version++;
+        return 0;
+}
+
+/**
+ * unpack
+ * Thaw the graph with every arc in the adjacency lists, where the
+ * removals work. Bulk arcs are frozen into them first.
+ */
+void Graph::unpack()
+{
+        if (!_frozen && _builder.has_bulk())
+                freeze();
+        thaw();
 }
 
-int Graph::link_two_vertices_undirected(int vertex_one, int vertex_two)
+/* Remove the arcs between two vertices of the unpacked graph, returns the
+ * number of removed arcs */
+int Graph::unlink(int vertex_one, int vertex_two, bool directed)
 {
-        if (vertex_one > static_cast<int>(_vertices.size() - 1) ||
-            vertex_two > static_cast<int>(_vertices.size() - 1))
+        int arcs = _builder.remove_arc(vertex_one, vertex_two);
+        if (!directed && vertex_one != vertex_two)
+                arcs += _builder.remove_arc(vertex_two, vertex_one);
+        /* one way of an undirected edge is left */
+        if (directed && arcs)
+                _directed = true;
+        return arcs;
+}
+
+/**
+ * remove_edge
+ * Remove the edge between two vertices, or only the arc from
+ * `vertex_one` to `vertex_two` when `directed` is set. Returns -1 for an
+ * unknown vertex or when there was no such edge.
+ */
+int Graph::remove_edge(int vertex_one, int vertex_two, bool directed)
+{
+        int count = _names.size();
+        if (vertex_one < 0 || vertex_one >= count ||
+            vertex_two < 0 || vertex_two >= count ||
+            removed(vertex_one) || removed(vertex_two))
+                return -1;
+
+        unpack();
+        if (!unlink(vertex_one, vertex_two, directed))
                 return -1;
+        _version++;
+        return 0;
+}
+
+/**
+ * drop_vertex
+ * Turn `vertex` into a tombstone without arcs. The arcs leading to it are
+ * found through its own ones in an undirected graph, a directed one needs
+ * a sweep over all lists, which purge() does for all removed vertices.
+ */
+void Graph::drop_vertex(int vertex)
+{
+        _removed.resize(_names.size(), 0);
+        if (_directed) {
+                _unpurged = true;
+        } else {
+                for (int adj : _builder.arcs(vertex)) {
+                        if (adj != vertex)
+                                _builder.remove_arc(adj, vertex);
+                }
+        }
+        _builder.clear_arcs(vertex);
+        _removed[vertex] = 1;
+        _removed_count++;
+}
+
+void Graph::revive(int vertex)
+{
+        /* the arcs added from now on may lead to it */
+        if (_unpurged)
+                purge();
+        _removed[vertex] = 0;
+        _removed_count--;
+        _version++;
+}
+
+/* Remove the arcs leading to removed vertices from the unpacked graph */
+void Graph::purge()
+{
+        _removed.resize(_names.size(), 0);
+        _builder.remove_arcs_to(_removed);
+        _unpurged = false;
+}
 
-        _adj_matrix[vertex_one][vertex_two] = 1;
-        _adj_matrix[vertex_two][vertex_one] = 1;
+/**
+ * remove_vertex
+ * Remove `vertex` with all arcs leaving and entering it, its index stays
+ * in use as a tombstone until the graph is compacted. Returns -1 for an
+ * unknown vertex.
+ */
+int Graph::remove_vertex(int vertex)
+{
+        if (vertex < 0 || vertex >= _names.size() || removed(vertex))
+                return -1;
 
+        unpack();
+        drop_vertex(vertex);
+        if (_unpurged)
+                purge();
+        _version++;
         return 0;
 }
 
-std::vector<int> Graph::adjacent_vertices(int vertex)
+/**
+ * compact
+ * Renumber the vertices that are left in their order, dropping the
+ * tombstones. Returns the new index of every old one, -1 for the removed.
+ */
+std::vector<int> Graph::compact()
 {
-        std::vector<int> adjacent;
-        int index = 0;
-        for (auto& row : _adj_matrix) {
-                if (index != vertex) {
-                        index++;
+        std::vector<int> mapping(_names.size());
+        if (!_removed_count) {
+                for (int vertex = 0 ; vertex < _names.size() ; vertex++) {
+                        mapping[vertex] = vertex;
+                }
+                return mapping;
+        }
+
+        unpack();
+        if (_unpurged)
+                purge();
+        SymbolTable names;
+        int count = 0;
+        for (int vertex = 0 ; vertex < _names.size() ; vertex++) {
+                if (removed(vertex)) {
+                        mapping[vertex] = -1;
                         continue;
                 }
-                int row_index = 0;
-                for (auto& column : row) {
-                        if (column != 1 || row_index == vertex) {
-                                row_index++;
-                                continue;
-                        }
-                        adjacent.push_back(row_index++);
+                mapping[vertex] = count++;
+                names.intern(_names.data(vertex), _names.length(vertex));
+        }
+        _builder.compact(mapping, count);
+        _names = names;
+        /* neither the names nor the arrays use the mapping anymore */
+        _snapshot.reset();
+        std::vector<char>().swap(_removed);
+        _removed_count = 0;
+        _version++;
+        return mapping;
+}
+
+/**
+ * apply
+ * Apply the changes of `batch` in order, the graph is unpacked once for
+ * all of them and frozen again by the next query. Changes of unknown
+ * vertices or edges are skipped.
+ * Returns the number of applied changes.
+ */
+int Graph::apply(const std::vector<Mutation>& batch)
+{
+        int applied = 0;
+        unpack();
+        for (auto& mutation : batch) {
+                int from = find_vertex(mutation.from);
+                int to = find_vertex(mutation.to);
+                switch (mutation.kind) {
+                case Mutation::Kind::AddVertex:
+                        create_vertex(mutation.from);
+                        applied++;
+                        break;
+                case Mutation::Kind::RemoveVertex:
+                        if (from < 0)
+                                break;
+                        drop_vertex(from);
+                        applied++;
+                        break;
+                case Mutation::Kind::AddEdge:
+                        from = create_vertex(mutation.from);
+                        to = create_vertex(mutation.to);
+                        if ((mutation.directed ?
+                             link_two_vertices_directed(from, to,
+                                                        mutation.weight) :
+                             link_two_vertices_undirected(from, to,
+                                                          mutation.weight))
+                            == 0)
+                                applied++;
+                        break;
+                case Mutation::Kind::RemoveEdge:
+                        if (from >= 0 && to >= 0 &&
+                            unlink(from, to, mutation.directed))
+                                applied++;
+                        break;
                 }
-                index++;
         }
-        return adjacent;
+        if (_unpurged)
+                purge();
+        _version++;
+        if (_compaction_ratio > 0 &&
+            _removed_count > _compaction_ratio * _names.size())
+                compact();
+        return applied;
+}
+
+/**
+ * freeze
+ * Pack the adjacency lists into the compact CSR layout.
+ *
+ * Called implicitly by every query, loaders can call it explicitly once the
+ * graph is complete. Further modifications thaw the graph again. Directed
+ * graphs get the reverse arcs as well, for searches walking backwards.
+ *
+ * The bit matrix has no room for weights, weighted graphs keep the CSR
+ * arrays next to it.
+ */
+void Graph::freeze()
+{
+        if (_frozen)
+                return;
+        /* the matrices are set from the CSR arrays, the sorting and
+         * deduplication of bulk arcs happens there */
+        _csr.freeze(_builder);
+        if (_directed)
+                _csr_in.transpose(_csr);
+        if (_storage == StorageMode::BitMatrix) {
+                _bit_matrix.assign(_csr);
+                if (_directed)
+                        _bit_matrix_in.assign(_csr_in);
+                /* unweighted searches only use the matrices */
+                if (!_weighted) {
+                        _csr = CsrGraph();
+                        _csr_in = CsrGraph();
+                }
+        }
+        _frozen = true;
+}
+
+void Graph::thaw()
+{
+        if (!_frozen)
+                return;
+        if (_storage == StorageMode::BitMatrix && !_weighted) {
+                _bit_matrix.thaw(_builder);
+        } else {
+                _csr.thaw(_builder);
+                _bit_matrix = BitMatrix();
+        }
+        /* the reverse arcs are rebuilt from the lists */
+        _landmarks.clear();
+        _guided.reset();
+        _csr_in = CsrGraph();
+        _bit_matrix_in = BitMatrix();
+        _frozen = false;
+}
+
+/**
+ * save_snapshot
+ * Store the frozen graph as a binary snapshot at `path`.
+ */
+bool Graph::save_snapshot(const std::string& path)
+{
+        /* the removed vertices are left out, and so is a landmark index */
+        if (_removed_count) {
+                Graph graph;
+                induced(live_vertices(), graph);
+                return graph.save_snapshot(path);
+        }
+        freeze();
+        if (_storage == StorageMode::Csr || _weighted)
+                return Snapshot::write(path, _names, _csr,
+                                       _directed ? &_csr_in : nullptr,
+                                       &_landmarks);
+
+        CsrBuilder builder;
+        CsrGraph csr, reverse;
+        for (int vertex = 0 ; vertex < _bit_matrix.vertices() ; vertex++) {
+                builder.add_vertex();
+                _bit_matrix.for_each(vertex, [&](int adj) {
+                        builder.add_arc(vertex, adj);
+                });
+        }
+        csr.freeze(builder);
+        if (_directed)
+                reverse.transpose(csr);
+        return Snapshot::write(path, _names, csr,
+                               _directed ? &reverse : nullptr, &_landmarks);
+}
+
+/**
+ * load_snapshot
+ * Replace the graph with the snapshot at `path`.
+ *
+ * The snapshot is mapped and its arrays are used in place, they are only
+ * copied once the graph is modified. The bit matrix is built from them
+ * when it is the selected storage.
+ */
+bool Graph::load_snapshot(const std::string& path)
+{
+        std::shared_ptr<Snapshot> snapshot(new Snapshot());
+        if (!snapshot->open(path))
+                return false;
+
+        _builder.clear();
+        std::vector<char>().swap(_removed);
+        _removed_count = 0;
+        _unpurged = false;
+        _directed = snapshot->directed();
+        _weighted = snapshot->weighted();
+        snapshot->attach(&_names, &_csr, &_csr_in, &_landmarks);
+        _guided.reset();
+        _version++;
+        _snapshot = snapshot;
+        _frozen = true;
+        if (_storage == StorageMode::BitMatrix) {
+                _csr.thaw(_builder);
+                _csr_in = CsrGraph();
+                _frozen = false;
+                freeze();
+        }
+        return true;
+}
+
+/**
+ * set_storage
+ * Select the layout of the frozen adjacency structure.
+ *
+ * The bit matrix needs V * V / 8 bytes and pays off for dense graphs, the
+ * CSR layout needs memory proportional to the number of edges.
+ */
+void Graph::set_storage(StorageMode mode)
+{
+        if (mode == _storage)
+                return;
+        thaw();
+        _storage = mode;
+        _version++;
 }
 
+/**
+ * breadth_first_search
+ * Find a path with the minimal number of hops between two vertex indices.
+ * Returns an empty path when the goal is not reachable from the start.
+ *
+ * A source asked for repeatedly gets its complete BFS tree searched and
+ * cached, which answers the queries to all other goals. The working arrays
+ * of the search are freed from the arena when it returns.
+ */
 std::vector<int> Graph::breadth_first_search(int start_index, int goal_index)
 {
-        int current;
-        std::queue<int> queue;
-        std::vector<int> visited;
-        std::vector<int> origin;
-        std::vector<int> path;
-        if (start_index == goal_index) {
-                path.push_back(start_index);
-                return path;
+        bool wanted;
+        const std::vector<int>* tree = _cache.find_tree(start_index, wanted);
+        if (tree)
+                return tree_path(*tree, start_index, goal_index);
+
+        freeze();
+        int goal = wanted ? -1 : goal_index;
+        Arena::Scope scope(arena());
+        if (_storage == StorageMode::BitMatrix) {
+                BfsEngine<BitMatrix> engine(_bit_matrix, bit_matrix_in(),
+                                            &arena());
+                engine.run(start_index, goal);
+                if (wanted)
+                        _cache.store_tree(start_index,
+                                          engine.parents().data(),
+                                          vertices());
+                return engine.path(goal_index);
         }
+        BfsEngine<CsrGraph> engine(_csr, csr_in(), &arena());
+        engine.run(start_index, goal);
+        if (wanted)
+                _cache.store_tree(start_index, engine.parents().data(),
+                                  vertices());
+        return engine.path(goal_index);
+}
 
-        queue.push(start_index);
-        visited.push_back(start_index);
-        origin.push_back(-1);
+std::vector<int> Graph::bidirectional_search(int start_index, int goal_index)
+{
+        freeze();
+        Arena::Scope scope(arena());
+        if (_storage == StorageMode::BitMatrix) {
+                BidirectionalBfs<BitMatrix> engine(_bit_matrix,
+                                                   bit_matrix_in(),
+                                                   &arena());
+                return engine.run(start_index, goal_index);
+        }
+        BidirectionalBfs<CsrGraph> engine(_csr, csr_in(), &arena());
+        return engine.run(start_index, goal_index);
+}
 
-        while (!queue.empty()) {
-                current = queue.front();
-                if (current == goal_index)
-                        break;
-                queue.pop();
-                for (auto& adj : this->adjacent_vertices(current)) {
-                        if (std::find(visited.begin(), visited.end(), adj)
-                            != visited.end())
-                                continue;
-                        visited.push_back(adj);
-                        origin.push_back(current);
-                        queue.push(adj);
-                }
+/**
+ * parallel_search
+ * Breadth first search on `_threads` threads, the level of every vertex is
+ * stored in `levels` if given.
+ */
+std::vector<int> Graph::parallel_search(int start_index, int goal_index,
+                                        std::vector<int>* levels)
+{
+        freeze();
+        if (_storage == StorageMode::BitMatrix) {
+                ParallelBfs<BitMatrix> engine(_bit_matrix, _threads);
+                engine.run(start_index, goal_index);
+                if (levels)
+                        *levels = engine.levels();
+                return engine.path(goal_index);
         }
+        ParallelBfs<CsrGraph> engine(_csr, _threads);
+        engine.run(start_index, goal_index);
+        if (levels)
+                *levels = engine.levels();
+        return engine.path(goal_index);
+}
 
-        if (std::find(visited.begin(), visited.end(), goal_index)
-            == visited.end()) {
-                path.push_back(-1);
-                return path;
+/**
+ * weighted_search
+ * Find a path with the minimal sum of arc weights between two vertex
+ * indices, with Dijkstra or with the `parallel` delta-stepping search.
+ */
+std::vector<int> Graph::weighted_search(int start_index, int goal_index,
+                                        bool parallel)
+{
+        freeze();
+        /* without weights every arc weighs 1 and hops are the distance */
+        if (_storage == StorageMode::BitMatrix && !_weighted)
+                return breadth_first_search(start_index, goal_index);
+        if (parallel) {
+                DeltaStepping engine(_csr, _threads);
+                engine.run(start_index, goal_index);
+                return engine.path(goal_index);
         }
+        Dijkstra engine(_csr);
+        engine.run(start_index, goal_index);
+        return engine.path(goal_index);
+}
 
-        int next = goal_index;
-        while (next >= 0) {
-                int index = 0;
-                for (auto& visit : visited) {
-                        if (visit == next) {
-                                next = origin[index];
-                                path.push_back(visit);
-                        }
-                        index++;
+/**
+ * build_landmarks
+ * Compute the landmark index of the frozen graph, which lets Landmarks
+ * queries run as A* searches. The index is stored in snapshots and lives
+ * until the graph is modified.
+ *
+ * Building it costs `count` complete searches per direction and
+ * `count` floats per vertex and direction.
+ */
+bool Graph::build_landmarks(int count)
+{
+        freeze();
+        if (_storage == StorageMode::BitMatrix && !_weighted) {
+                std::cerr << "ERROR: The landmark index needs the CSR "
+                          << "storage." << std::endl;
+                return false;
+        }
+        if (count <= 0 || empty()) {
+                std::cerr << "ERROR: A landmark index needs at least one "
+                          << "landmark and vertex." << std::endl;
+                return false;
+        }
+        _landmarks.build(_csr, csr_in(), _directed, count);
+        _version++;
+        return true;
+}
+
+/**
+ * landmark_search
+ * A* search between two vertex indices, guided by the landmark index.
+ * Without an index it is a plain Dijkstra.
+ */
+std::vector<int> Graph::landmark_search(int start_index, int goal_index)
+{
+        freeze();
+        if (_storage == StorageMode::BitMatrix && !_weighted)
+                return breadth_first_search(start_index, goal_index);
+        if (!_guided)
+                _guided.reset(new Dijkstra(_csr));
+        _guided->run(start_index, goal_index,
+                     _landmarks.empty() ? nullptr : &_landmarks);
+        return _guided->path(goal_index);
+}
+
+/* Sum of the arc weights along `path` */
+double Graph::path_length(const std::vector<int>& path)
+{
+        freeze();
+        double length = 0;
+        for (std::size_t index = 1 ; index < path.size() ; index++) {
+                if (!_weighted) {
+                        length += 1;
+                        continue;
                 }
+                const int* adj = std::lower_bound(_csr.begin(path[index - 1]),
+                                                  _csr.end(path[index - 1]),
+                                                  path[index]);
+                length += _csr.weight(adj);
         }
-        std::reverse(path.begin(), path.end());
+        return length;
+}
 
+/**
+ * shortest_path
+ * Answer a query from the cache, or search it and cache the result.
+ */
+std::vector<int> Graph::shortest_path(int start_index, int goal_index,
+                                      PathAlgorithm algorithm)
+{
+        _cache.validate(_version);
+        int key = static_cast<int>(algorithm);
+        const std::vector<int>* cached = _cache.find_path(start_index,
+                                                          goal_index, key);
+        if (cached)
+                return *cached;
+        std::vector<int> path = search(start_index, goal_index, algorithm);
+        _cache.store_path(start_index, goal_index, key, path);
         return path;
 }
 
-std::vector<char> Graph::get_shortest_path(char point_a, char point_b)
+std::vector<int> Graph::search(int start_index, int goal_index,
+                               PathAlgorithm algorithm)
+{
+        switch (algorithm) {
+        case PathAlgorithm::Dijkstra:
+                return weighted_search(start_index, goal_index, false);
+        case PathAlgorithm::DeltaStepping:
+                return weighted_search(start_index, goal_index, true);
+        case PathAlgorithm::Landmarks:
+                return landmark_search(start_index, goal_index);
+        case PathAlgorithm::ParallelBfs:
+                return parallel_search(start_index, goal_index, nullptr);
+        case PathAlgorithm::BidirectionalBfs:
+                return bidirectional_search(start_index, goal_index);
+        default:
+                return breadth_first_search(start_index, goal_index);
+        }
+}
+
+std::vector<std::string> Graph::get_shortest_path(const std::string& point_a,
+                                                  const std::string& point_b,
+                                                  PathAlgorithm algorithm)
+{
+        std::vector<std::string> vertex_path;
+        int start = find_vertex(point_a);
+        int goal = find_vertex(point_b);
+        if (start < 0 || goal < 0)
+                return vertex_path;
+
+        for (auto& path_element : shortest_path(start, goal, algorithm)) {
+                vertex_path.push_back(_names.name(path_element));
+        }
+
+        return vertex_path;
+}
+
+/**
+ * get_shortest_distance
+ * Sum of the arc weights along the shortest path found by `algorithm`,
+ * infinity when there is no path.
+ */
+double Graph::get_shortest_distance(const std::string& point_a,
+                                    const std::string& point_b,
+                                    PathAlgorithm algorithm)
+{
+        int start = find_vertex(point_a);
+        int goal = find_vertex(point_b);
+        if (start < 0 || goal < 0)
+                return std::numeric_limits<double>::infinity();
+        std::vector<int> path = shortest_path(start, goal, algorithm);
+        if (path.empty())
+                return std::numeric_limits<double>::infinity();
+        return path_length(path);
+}
+
+std::vector<char> Graph::get_shortest_path(char point_a, char point_b,
+                                           PathAlgorithm algorithm)
 {
         std::vector<char> vertex_path;
-        int index = 0;
-        int start = -1;
-        int goal = -1;
-        for (auto& vertex : _vertices) {
-                if (vertex == point_a)
-                        start = index;
-                if (vertex == point_b)
-                        goal = index;
-                index++;
+        int start = find_vertex(&point_a, 1);
+        int goal = find_vertex(&point_b, 1);
+        if (start < 0 || goal < 0)
+                return vertex_path;
+
+        for (auto& path_element : shortest_path(start, goal, algorithm)) {
+                vertex_path.push_back(*_names.data(path_element));
+        }
+
+        return vertex_path;
+}
+
+/**
+ * bfs_levels
+ * Hop distance from `source` to every vertex (indexed like the vertices),
+ * -1 for unreachable vertices. Computed by the parallel search.
+ */
+std::vector<int> Graph::bfs_levels(const std::string& source)
+{
+        std::vector<int> levels;
+        int start = find_vertex(source);
+        if (start < 0)
+                return levels;
+        parallel_search(start, -1, &levels);
+        return levels;
+}
+
+std::vector< std::vector<int> > Graph::shortest_paths(
+        const std::vector< std::pair<int, int> >& queries)
+{
+        freeze();
+        if (_storage == StorageMode::BitMatrix)
+                return batch_paths(_bit_matrix, bit_matrix_in(), queries);
+        return batch_paths(_csr, csr_in(), queries);
+}
+
+std::vector< std::vector<int> > Graph::distances(
+        const std::vector<int>& sources)
+{
+        freeze();
+        if (_storage == StorageMode::BitMatrix)
+                return batch_distances(_bit_matrix, bit_matrix_in(),
+                                       sources);
+        return batch_distances(_csr, csr_in(), sources);
+}
+
+/**
+ * get_shortest_paths
+ * Answer many shortest path queries with one bit-parallel search per 64
+ * distinct start vertices, instead of one search per query.
+ */
+std::vector< std::vector<std::string> > Graph::get_shortest_paths(
+        const std::vector< std::pair<std::string, std::string> >& queries)
+{
+        std::vector< std::vector<std::string> > vertex_paths(queries.size());
+        std::vector< std::pair<int, int> > index_queries;
+        std::vector<std::size_t> positions;
+
+        for (std::size_t index = 0 ; index < queries.size() ; index++) {
+                int start = find_vertex(queries[index].first);
+                int goal = find_vertex(queries[index].second);
+                if (start < 0 || goal < 0)
+                        continue;
+                index_queries.push_back(std::make_pair(start, goal));
+                positions.push_back(index);
         }
 
-        std::vector<int> path = breadth_first_search(start, goal);
+        std::vector< std::vector<int> > paths = shortest_paths(index_queries);
+        for (std::size_t index = 0 ; index < paths.size() ; index++) {
+                for (auto& path_element : paths[index]) {
+                        vertex_paths[positions[index]].push_back(
+                                _names.name(path_element));
+                }
+        }
+        return vertex_paths;
+}
+
+std::vector< std::vector<char> > Graph::get_shortest_paths(
+        const std::vector< std::pair<char, char> >& queries)
+{
+        std::vector< std::pair<std::string, std::string> > named;
+        for (auto& query : queries) {
+                named.push_back(std::make_pair(std::string(1, query.first),
+                                               std::string(1, query.second)));
+        }
 
-        for (auto& path_element : path) {
-                index = 0;
-                for (auto& vertex : _vertices) {
-                        if (index++ == path_element)
-                                vertex_path.push_back(vertex);
+        std::vector< std::vector<char> > vertex_paths;
+        for (auto& path : get_shortest_paths(named)) {
+                std::vector<char> vertex_path;
+                for (auto& name : path) {
+                        vertex_path.push_back(name.at(0));
                 }
+                vertex_paths.push_back(vertex_path);
         }
+        return vertex_paths;
+}
 
-        return vertex_path;
+/**
+ * distance_matrix
+ * Hop distance from every vertex of `sources` (rows) to every vertex
+ * (columns), -1 for unreachable vertices. Unknown sources get an empty row.
+ */
+std::vector< std::vector<int> > Graph::distance_matrix(
+        const std::vector<std::string>& sources)
+{
+        std::vector< std::vector<int> > matrix(sources.size());
+        std::vector<int> index_sources;
+        std::vector<std::size_t> positions;
+
+        for (std::size_t index = 0 ; index < sources.size() ; index++) {
+                int start = find_vertex(sources[index]);
+                if (start < 0)
+                        continue;
+                index_sources.push_back(start);
+                positions.push_back(index);
+        }
+
+        std::vector< std::vector<int> > rows = distances(index_sources);
+        for (std::size_t index = 0 ; index < rows.size() ; index++) {
+                matrix[positions[index]].swap(rows[index]);
+        }
+        return matrix;
+}
+
+std::vector< std::vector<int> > Graph::distance_matrix(
+        const std::vector<char>& sources)
+{
+        std::vector<std::string> named;
+        for (auto& source : sources) {
+                named.push_back(std::string(1, source));
+        }
+        return distance_matrix(named);
+}
+
+/* Length of the longest vertex name */
+int Graph::name_width()
+{
+        std::size_t width = 1;
+        for (int index = 0 ; index < _names.size() ; index++) {
+                width = std::max(width, _names.length(index));
+        }
+        return static_cast<int>(width);
+}
+
+/**
+ * neighbors
+ * The vertices at the end of the arcs leaving `vertex`, which has to
+ * exist, in ascending order.
+ */
+NeighborRange Graph::neighbors(int vertex)
+{
+        freeze();
+        if (_storage == StorageMode::BitMatrix)
+                return _bit_matrix.neighbors(vertex);
+        return _csr.neighbors(vertex);
+}
+
+/**
+ * view
+ * Freeze the graph and return a read-only view of it, for code that walks
+ * the arcs without copying them.
+ */
+GraphView Graph::view()
+{
+        freeze();
+        if (_storage == StorageMode::BitMatrix)
+                return GraphView(_names, _bit_matrix, bit_matrix_in(),
+                                 _directed);
+        return GraphView(_names, _csr, csr_in(), _directed);
 }
 
 void Graph::print_graph()
 {
-        /* print the head */
-        PrintCoordinates printer(_vertices, _adj_matrix);
+        StreamSink sink(std::cout);
+        print_graph(sink);
+}
+
+/* the drawings of a graph with removed vertices show a copy without them */
+void Graph::print_graph(OutputSink& sink)
+{
+        if (_removed_count) {
+                Graph graph;
+                induced(live_vertices(), graph);
+                graph.print_graph(sink);
+                return;
+        }
+        printer().print(sink);
+}
+
+void Graph::print_graph(const Viewport& viewport)
+{
+        StreamSink sink(std::cout);
+        print_graph(sink, viewport);
+}
+
+/**
+ * print_graph
+ * Print the part of the drawing within `viewport`. Only the cells of the
+ * window are written, the edges are laid out once per version of the
+ * graph, so paging through a large drawing doesn't lay it out again.
+ */
+void Graph::print_graph(OutputSink& sink, const Viewport& viewport)
+{
+        if (_removed_count) {
+                Graph graph;
+                induced(live_vertices(), graph);
+                graph.print_graph(sink, viewport);
+                return;
+        }
+        printer().print(sink, viewport);
+}
+
+/* the layout of the current version of the graph */
+PrintCoordinates& Graph::printer()
+{
+        if (!_printer || _printer_version != _version) {
+                _printer.reset(new PrintCoordinates(view(), _layout));
+                _printer_version = _version;
+        }
+        return *_printer;
+}
 
-        printer.print_head();
-        for (int row = 0 ; row < printer.rows() ; row++) {
-                int columns = static_cast<int>(_vertices.size());
-                for (int col = 0 ; col < columns ; col++) {
-                        printer.print_point(row, col);
+bool Graph::print_neighborhood(const std::string& center, int radius)
+{
+        StreamSink sink(std::cout);
+        return print_neighborhood(sink, center, radius);
+}
+
+/**
+ * print_neighborhood
+ * Print the drawing of the subgraph induced by the vertices at most
+ * `radius` arcs away from `center`, following the arcs both ways. The
+ * vertices keep their order in the graph.
+ */
+bool Graph::print_neighborhood(OutputSink& sink, const std::string& center,
+                               int radius)
+{
+        int source = find_vertex(center);
+        if (source < 0) {
+                std::cerr << "ERROR: Vertex " << center << " not found"
+                          << std::endl;
+                return false;
+        }
+        if (radius < 0) {
+                std::cerr << "ERROR: Negative radius " << radius << std::endl;
+                return false;
+        }
+        GraphView graph = view();
+        std::vector<char> seen(graph.vertices(), 0);
+        std::vector<int> ball(1, source);
+        seen[source] = 1;
+        auto visit = [&](int adj) {
+                if (seen[adj])
+                        return;
+                seen[adj] = 1;
+                ball.push_back(adj);
+        };
+        std::size_t level = 0;
+        for (int depth = 0 ; depth < radius ; depth++) {
+                std::size_t level_end = ball.size();
+                for ( ; level < level_end ; level++) {
+                        for (int adj : graph.neighbors(ball[level])) {
+                                visit(adj);
+                        }
+                        if (!_directed)
+                                continue;
+                        for (int adj : graph.in_neighbors(ball[level])) {
+                                visit(adj);
+                        }
                 }
         }
+
+        std::sort(ball.begin(), ball.end());
+        Graph neighborhood;
+        induced(ball, neighborhood);
+        neighborhood.print_graph(sink);
+        return true;
+}
+
+void Graph::print_matrix(MatrixFormat format)
+{
+        StreamSink sink(std::cout);
+        print_matrix(sink, format);
+}
+
+/**
+ * print_matrix
+ * Print the adjacency matrix in `format`. Only the dense grid is written
+ * cell by cell, the other formats are read off the arcs.
+ */
+void Graph::print_matrix(OutputSink& sink, MatrixFormat format)
+{
+        if (_removed_count) {
+                Graph graph;
+                induced(live_vertices(), graph);
+                graph.print_matrix(sink, format);
+                return;
+        }
+        switch (format) {
+        case MatrixFormat::EdgeList:
+                print_edge_list(sink);
+                break;
+        case MatrixFormat::MatrixMarket:
+                print_matrix_market(sink);
+                break;
+        case MatrixFormat::RunLength:
+                print_run_lengths(sink);
+                break;
+        default:
+                print_dense(sink);
+        }
+}
+
+/**
+ * write_name
+ * Write the name of `vertex`, quoted like a DOT identifier when it has
+ * white space or quotes in it, so that the fields of a line stay apart.
+ */
+void Graph::write_name(OutputSink& sink, int vertex)
+{
+        const char* name = _names.data(vertex);
+        std::size_t length = _names.length(vertex);
+        const char* special = std::find_if(name, name + length, [](char c) {
+                return c == '"' || c == '\\' ||
+                        isspace(static_cast<unsigned char>(c));
+        });
+        if (length > 0 && special == name + length) {
+                sink.write(name, length);
+                return;
+        }
+        sink.put('"');
+        for (std::size_t index = 0 ; index < length ; index++) {
+                if (name[index] == '"' || name[index] == '\\')
+                        sink.put('\\');
+                sink.put(name[index]);
+        }
+        sink.put('"');
+}
+
+/* Call `function` with the target and the weight of every arc leaving
+ * `vertex`, in ascending order of the targets */
+template <typename Function>
+void Graph::for_each_arc(int vertex, Function function)
+{
+        if (_weighted) {
+                _csr.for_each_weighted(vertex, function);
+                return;
+        }
+        for (int adj : neighbors(vertex)) {
+                function(adj, 1.0f);
+        }
+}
+
+/* The vertices that weren't removed, ascending */
+std::vector<int> Graph::live_vertices()
+{
+        std::vector<int> vertices;
+        for (int vertex = 0 ; vertex < _names.size() ; vertex++) {
+                if (!removed(vertex))
+                        vertices.push_back(vertex);
+        }
+        return vertices;
+}
+
+/**
+ * induced
+ * Fill the empty `subgraph` with `vertices`, which are ascending, and the
+ * arcs between them. The subgraph is drawn with the same layout.
+ */
+void Graph::induced(const std::vector<int>& vertices, Graph& subgraph)
+{
+        freeze();
+        std::vector<int> local(_names.size(), -1);
+        std::vector<std::string> names;
+        names.reserve(vertices.size());
+        for (std::size_t index = 0 ; index < vertices.size() ; index++) {
+                local[vertices[index]] = static_cast<int>(index);
+                names.push_back(_names.name(vertices[index]));
+        }
+        std::vector<Arc> arcs;
+        for (int vertex : vertices) {
+                for_each_arc(vertex, [&](int adj, float weight) {
+                        if (local[adj] < 0)
+                                return;
+                        Arc arc = { local[vertex], local[adj], weight };
+                        arcs.push_back(arc);
+                });
+        }
+
+        subgraph.set_layout(_layout);
+        subgraph.reserve(static_cast<int>(vertices.size()), arcs.size(),
+                         _directed);
+        subgraph.add_vertices(names);
+        subgraph.add_edges(arcs, _directed);
+}
+
+/**
+ * print_edge_list
+ * One line `from to` per edge, followed by the weight in a weighted
+ * graph. The edges of an undirected graph are listed once.
+ */
+void Graph::print_edge_list(OutputSink& sink)
+{
+        freeze();
+        for (int vertex = 0 ; vertex < _names.size() ; vertex++) {
+                for_each_arc(vertex, [&](int adj, float weight) {
+                        if (!_directed && adj < vertex)
+                                return;
+                        write_name(sink, vertex);
+                        sink.put(' ');
+                        write_name(sink, adj);
+                        if (_weighted) {
+                                sink.put(' ');
+                                sink.write_real(weight);
+                        }
+                        sink.put('\n');
+                });
+        }
 }
 
-void Graph::print_matrix()
+/**
+ * print_matrix_market
+ * The matrix in the coordinate format of Matrix Market, rows and columns
+ * are the vertex indices + 1. Undirected graphs are stored as symmetric
+ * matrices, which only list the entries below the diagonal and on it.
+ */
+void Graph::print_matrix_market(OutputSink& sink)
 {
-        std::cout << "  | ";
-        for (auto& vertex : _vertices) {
-                std::cout << vertex << " ";
+        freeze();
+        long entries = 0;
+        for (int vertex = 0 ; vertex < _names.size() ; vertex++) {
+                for_each_arc(vertex, [&](int adj, float) {
+                        if (_directed || adj <= vertex)
+                                entries++;
+                });
         }
-        std::cout << std::endl;
-        std::cout << "--|-";
-        int columns = static_cast<int>(_vertices.size());
+        sink.write("%%MatrixMarket matrix coordinate ");
+        sink.write(_weighted ? "real " : "pattern ");
+        sink.write(_directed ? "general\n" : "symmetric\n");
+        sink.write_integer(_names.size());
+        sink.put(' ');
+        sink.write_integer(_names.size());
+        sink.put(' ');
+        sink.write_integer(entries);
+        sink.put('\n');
+        for (int vertex = 0 ; vertex < _names.size() ; vertex++) {
+                for_each_arc(vertex, [&](int adj, float weight) {
+                        if (!_directed && adj > vertex)
+                                return;
+                        sink.write_integer(vertex + 1);
+                        sink.put(' ');
+                        sink.write_integer(adj + 1);
+                        if (_weighted) {
+                                sink.put(' ');
+                                sink.write_real(weight);
+                        }
+                        sink.put('\n');
+                });
+        }
+}
+
+/**
+ * print_run_lengths
+ * Every row of the matrix as the lengths of its runs of 0 and 1, starting
+ * with a run of 0 that may be empty. The trailing run of 0 is left out.
+ */
+void Graph::print_run_lengths(OutputSink& sink)
+{
+        int width = name_width();
+        int columns = _names.size();
+        sink.write("# ");
+        sink.write_integer(columns);
+        sink.write(" columns, runs of 0 and 1 per row\n");
+        freeze();
+        for (int row = 0 ; row < columns ; row++) {
+                sink.write(pad(_names.name(row), width));
+                sink.write(" |", 2);
+                /* the end of the last run of 1 and its length */
+                int end = 0;
+                int ones = 0;
+                for (int adj : neighbors(row)) {
+                        if (ones > 0 && adj == end) {
+                                ones++;
+                                end++;
+                                continue;
+                        }
+                        if (ones > 0) {
+                                sink.put(' ');
+                                sink.write_integer(ones);
+                        }
+                        sink.put(' ');
+                        sink.write_integer(adj - end);
+                        ones = 1;
+                        end = adj + 1;
+                }
+                if (ones > 0) {
+                        sink.put(' ');
+                        sink.write_integer(ones);
+                }
+                sink.put('\n');
+        }
+}
+
+/**
+ * print_dense
+ * Print the adjacency matrix, every column is as wide as the longest
+ * vertex name.
+ */
+void Graph::print_dense(OutputSink& sink)
+{
+        int width = name_width();
+        int columns = _names.size();
+
+        sink.fill(' ', width);
+        sink.write(" | ", 3);
         for (int col = 0 ; col < columns ; col++) {
-                std::cout << "--";
+                sink.write(pad(_names.name(col), width));
+                sink.put(' ');
         }
-        std::cout << std::endl;
+        sink.put('\n');
+        sink.fill('-', width);
+        sink.write("-|-", 3);
+        sink.fill('-', static_cast<std::size_t>(columns) * (width + 1));
+        sink.put('\n');
 
-        int row_index = 0;
-        for (auto& row : _adj_matrix) {
-                std::cout << _vertices[row_index++] << " | ";
-                for (auto& col : row) {
-                        std::cout << col << " ";
+        /* the cells are copied, the columns between two neighbors at once */
+        GraphView graph = view();
+        std::string one = pad("1", width) + " ";
+        std::string zero = pad("0", width) + " ";
+        for (int row = 0 ; row < columns ; row++) {
+                sink.write(pad(_names.name(row), width));
+                sink.write(" | ", 3);
+                int col = 0;
+                for (int adj : graph.neighbors(row)) {
+                        for ( ; col < adj ; col++) {
+                                sink.write(zero);
+                        }
+                        sink.write(one);
+                        col++;
+                }
+                for ( ; col < columns ; col++) {
+                        sink.write(zero);
                 }
-                std::cout << std::endl;
+                sink.put('\n');
         }
-        std::cout << std::endl;
+        sink.put('\n');
 }
 } /* namespace ascii_graph */
@@ -0,0 +1,209 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "landmarks.h"
+
+namespace ascii_graph {
+/* The float nearest to `distance` that isn't larger */
+static float round_down(double distance)
+{
+        float rounded = static_cast<float>(distance);
+        if (rounded > distance)
+                rounded = std::nextafter(rounded, 0.0f);
+        return rounded;
+}
+
+LandmarkIndex::LandmarkIndex()
+        : _landmark_data(nullptr), _from_data(nullptr), _to_data(nullptr),
+          _count(0), _vertices(0), _attached(false)
+{
+}
+
+LandmarkIndex::LandmarkIndex(const LandmarkIndex& other)
+        : _landmarks(other._landmarks), _from(other._from), _to(other._to),
+          _count(other._count), _vertices(other._vertices),
+          _attached(other._attached)
+{
+        if (other._attached) {
+                _landmark_data = other._landmark_data;
+                _from_data = other._from_data;
+                _to_data = other._to_data;
+        } else {
+                view();
+        }
+}
+
+LandmarkIndex& LandmarkIndex::operator=(const LandmarkIndex& other)
+{
+        if (this == &other)
+                return *this;
+        _landmarks = other._landmarks;
+        _from = other._from;
+        _to = other._to;
+        _count = other._count;
+        _vertices = other._vertices;
+        _attached = other._attached;
+        if (other._attached) {
+                _landmark_data = other._landmark_data;
+                _from_data = other._from_data;
+                _to_data = other._to_data;
+        } else {
+                view();
+        }
+        return *this;
+}
+
+/* point the arrays in use at the own vectors */
+void LandmarkIndex::view()
+{
+        _landmark_data = _landmarks.data();
+        _from_data = _from.data();
+        _to_data = _to.empty() ? _from_data : _to.data();
+}
+
+void LandmarkIndex::clear()
+{
+        std::vector<int>().swap(_landmarks);
+        std::vector<float>().swap(_from);
+        std::vector<float>().swap(_to);
+        _count = _vertices = 0;
+        _attached = false;
+        view();
+}
+
+/**
+ * build
+ * Pick up to `count` landmarks of the graph with the arcs `out` and compute
+ * their distances, `in` holds the reverse arcs of a `directed` graph.
+ *
+ * Every landmark costs one complete Dijkstra run per direction.
+ */
+void LandmarkIndex::build(const CsrGraph& out, const CsrGraph& in,
+                          bool directed, int count)
+{
+        clear();
+        int vertices = out.vertices();
+        count = std::min(count, vertices);
+        if (count <= 0)
+                return;
+
+        const float infinity = std::numeric_limits<float>::infinity();
+        std::size_t size = static_cast<std::size_t>(vertices) * count;
+        _from.assign(size, infinity);
+        if (directed)
+                _to.assign(size, infinity);
+        Dijkstra forward(out);
+        Dijkstra backward(in);
+        std::vector<double> nearest(vertices,
+                                    std::numeric_limits<double>::infinity());
+        std::vector<char> chosen(vertices, 0);
+
+        /* the first landmark is the vertex farthest from vertex 0 */
+        int next = 0;
+        forward.run(0);
+        for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                if (forward.reached(vertex) &&
+                    forward.distance(vertex) > forward.distance(next))
+                        next = vertex;
+        }
+        for (int index = 0 ; index < count ; index++) {
+                _landmarks.push_back(next);
+                chosen[next] = 1;
+                forward.run(next);
+                if (directed)
+                        backward.run(next);
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        std::size_t slot = static_cast<std::size_t>(vertex) *
+                                count + index;
+                        _from[slot] = round_down(forward.distance(vertex));
+                        if (directed)
+                                _to[slot] = round_down(
+                                        backward.distance(vertex));
+                        nearest[vertex] = std::min(nearest[vertex],
+                                                   forward.distance(vertex));
+                }
+                /* the next one is the vertex farthest from all landmarks,
+                 * unreached vertices of other components come first */
+                next = -1;
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        if (!chosen[vertex] &&
+                            (next < 0 || nearest[vertex] > nearest[next]))
+                                next = vertex;
+                }
+        }
+        _count = count;
+        _vertices = vertices;
+        view();
+}
+
+/**
+ * attach
+ * Use the arrays of a mapped snapshot, `to` is null for an undirected
+ * graph.
+ */
+void LandmarkIndex::attach(const int* landmarks, int count,
+                           const float* from, const float* to, int vertices)
+{
+        clear();
+        _landmark_data = landmarks;
+        _from_data = from;
+        _to_data = to ? to : from;
+        _count = count;
+        _vertices = vertices;
+        _attached = true;
+}
+
+/**
+ * bound
+ * Lower bound of the distance from `vertex` to `goal`.
+ *
+ * The stored distances are rounded down to float, so the subtracted one
+ * may be short by less than one float ulp of itself. The larger term is
+ * scaled down by one float epsilon to cover that, which also covers
+ * snapshots written with distances rounded to nearest.
+ */
+double LandmarkIndex::bound(int vertex, int goal) const
+{
+        const float* from_vertex = _from_data +
+                static_cast<std::size_t>(vertex) * _count;
+        const float* from_goal = _from_data +
+                static_cast<std::size_t>(goal) * _count;
+        const float* to_vertex = _to_data +
+                static_cast<std::size_t>(vertex) * _count;
+        const float* to_goal = _to_data +
+                static_cast<std::size_t>(goal) * _count;
+        const double slack = std::numeric_limits<float>::epsilon();
+        double best = 0;
+        for (int index = 0 ; index < _count ; index++) {
+                /* an infinite difference proves that the goal can't be
+                 * reached, a difference of two infinities is NaN and fails
+                 * both comparisons */
+                double ahead = from_goal[index] * (1.0 - slack) -
+                        from_vertex[index];
+                double behind = to_vertex[index] * (1.0 - slack) -
+                        to_goal[index];
+                if (ahead > best)
+                        best = ahead;
+                if (behind > best)
+                        best = behind;
+        }
+        return best;
+}
+} /* namespace ascii_graph */
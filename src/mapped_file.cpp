@@ -0,0 +1,71 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mapped_file.h"
+
+namespace ascii_graph {
+/**
+ * open
+ * Map the regular file at `path`. Returns false if the file can't be
+ * opened or isn't a regular file (pipes and terminals can't be mapped).
+ * A `sequential` mapping is read front to back, pages behind the reader
+ * may be dropped early.
+ */
+bool MappedFile::open(const std::string& path, bool sequential)
+{
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+                return false;
+
+        struct stat info;
+        if (fstat(fd, &info) < 0 || !S_ISREG(info.st_mode)) {
+                ::close(fd);
+                return false;
+        }
+        if (info.st_size == 0) {
+                ::close(fd);
+                _open_empty = true;
+                return true;
+        }
+
+        void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd,
+                          0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+                return false;
+        if (sequential)
+                madvise(data, info.st_size, MADV_SEQUENTIAL);
+
+        _data = static_cast<const char*>(data);
+        _size = static_cast<std::size_t>(info.st_size);
+        return true;
+}
+
+void MappedFile::close()
+{
+        if (_data)
+                munmap(const_cast<char*>(_data), _size);
+        _data = nullptr;
+        _size = 0;
+        _open_empty = false;
+}
+} /* namespace ascii_graph */
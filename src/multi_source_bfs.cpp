@@ -0,0 +1,110 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include "multi_source_bfs.h"
+#include "csr.h"
+#include "bit_matrix.h"
+
+namespace ascii_graph {
+template <typename Adjacency>
+MultiSourceBfs<Adjacency>::MultiSourceBfs(const Adjacency& out,
+                                          const Adjacency& in)
+        : _out(out), _in(in), _count(out.vertices())
+{
+}
+
+/**
+ * run
+ * Search from every vertex in `sources` (at most `lanes`), source `i`
+ * uses lane `i`.
+ */
+template <typename Adjacency>
+void MultiSourceBfs<Adjacency>::run(const std::vector<int>& sources)
+{
+        _seen.assign(_count, 0);
+        _visit.assign(_count, 0);
+        _visit_next.assign(_count, 0);
+        _distance.assign(static_cast<std::size_t>(_count) * lanes, -1);
+
+        int lane = 0;
+        for (auto& source : sources) {
+                _seen[source] |= uint64_t(1) << lane;
+                _visit[source] |= uint64_t(1) << lane;
+                _distance[static_cast<std::size_t>(source) * lanes + lane] = 0;
+                lane++;
+        }
+
+        bool active = !sources.empty();
+        for (int level = 1 ; active ; level++) {
+                active = false;
+                for (int vertex = 0 ; vertex < _count ; vertex++) {
+                        uint64_t visit = _visit[vertex];
+                        if (!visit)
+                                continue;
+                        _out.for_each(vertex, [&](int adj) {
+                                uint64_t discovered = visit & ~_seen[adj];
+                                if (!discovered)
+                                        return;
+                                _visit_next[adj] |= discovered;
+                                _seen[adj] |= discovered;
+                                int* distance = _distance.data() +
+                                        static_cast<std::size_t>(adj) * lanes;
+                                while (discovered) {
+                                        distance[__builtin_ctzll(discovered)] =
+                                                level;
+                                        discovered &= discovered - 1;
+                                }
+                                active = true;
+                        });
+                }
+                _visit.swap(_visit_next);
+                std::fill(_visit_next.begin(), _visit_next.end(), 0);
+        }
+}
+
+/**
+ * path
+ * Rebuild a shortest path to `goal` for the source of `lane` by stepping
+ * back along incoming arcs to vertices one level closer to the source.
+ * Returns an empty path when `goal` is unreachable.
+ */
+template <typename Adjacency>
+std::vector<int> MultiSourceBfs<Adjacency>::path(int lane, int goal) const
+{
+        std::vector<int> result;
+        int level = distance(lane, goal);
+        if (level < 0)
+                return result;
+
+        result.push_back(goal);
+        for (int current = goal ; level > 0 ; level--) {
+                int previous = -1;
+                _in.for_each(current, [&](int adj) {
+                        if (previous < 0 && distance(lane, adj) == level - 1)
+                                previous = adj;
+                });
+                result.push_back(previous);
+                current = previous;
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+}
+
+template class MultiSourceBfs<CsrGraph>;
+template class MultiSourceBfs<BitMatrix>;
+} /* namespace ascii_graph */
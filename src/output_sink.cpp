@@ -0,0 +1,105 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include "output_sink.h"
+
+namespace ascii_graph {
+OutputSink::OutputSink(std::size_t capacity)
+        : _buffer(std::max<std::size_t>(capacity, 1)),
+          _capacity(_buffer.size())
+{
+}
+
+void OutputSink::fill(char character, std::size_t count)
+{
+        while (count > 0) {
+                if (_used == _capacity)
+                        flush();
+                std::size_t length = std::min(count, _capacity - _used);
+                std::fill(_buffer.data() + _used,
+                          _buffer.data() + _used + length, character);
+                _used += length;
+                count -= length;
+        }
+}
+
+void OutputSink::write_integer(long value)
+{
+        char digits[24];
+        char* first = digits + sizeof(digits);
+        unsigned long magnitude = value < 0 ?
+                -static_cast<unsigned long>(value) : value;
+        do {
+                *--first = static_cast<char>('0' + magnitude % 10);
+                magnitude /= 10;
+        } while (magnitude);
+        if (value < 0)
+                *--first = '-';
+        write(first, digits + sizeof(digits) - first);
+}
+
+void OutputSink::write_real(double value)
+{
+        char digits[32];
+        int length = snprintf(digits, sizeof(digits), "%.9g", value);
+        write(digits, length);
+}
+
+void OutputSink::flush()
+{
+        if (_used == 0)
+                return;
+        deliver(_buffer.data(), _used);
+        _used = 0;
+}
+
+/* Text larger than the free space, pieces as large as the whole buffer
+ * are delivered without copying them */
+void OutputSink::write_large(const char* text, std::size_t length)
+{
+        flush();
+        if (length >= _capacity) {
+                deliver(text, length);
+                return;
+        }
+        std::copy(text, text + length, _buffer.data());
+        _used = length;
+}
+
+void FdSink::deliver(const char* text, std::size_t length)
+{
+        while (length > 0 && !_failed) {
+                ssize_t written = ::write(_fd, text, length);
+                if (written < 0 && errno == EINTR)
+                        continue;
+                if (written < 0) {
+                        std::cerr << "ERROR: Writing the output failed: "
+                                  << strerror(errno) << std::endl;
+                        _failed = true;
+                        return;
+                }
+                text += written;
+                length -= written;
+        }
+}
+} /* namespace ascii_graph */
@@ -0,0 +1,181 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <thread>
+#include "parallel_bfs.h"
+#include "barrier.h"
+#include "csr.h"
+#include "bit_matrix.h"
+
+namespace ascii_graph {
+/* Number of frontier vertices handed out at once */
+static const long chunk_size = 64;
+/* Parent of a vertex that wasn't discovered yet, reported as -1 like the
+ * parent of the source */
+static const int undiscovered = -2;
+
+int default_thread_count()
+{
+        unsigned int count = std::thread::hardware_concurrency();
+        return count ? static_cast<int>(count) : 1;
+}
+
+template <typename Adjacency>
+ParallelBfs<Adjacency>::ParallelBfs(const Adjacency& out, int threads)
+        : _out(out), _count(out.vertices()),
+          _threads(threads > 0 ? threads : default_thread_count()),
+          _parent(new std::atomic<int>[_count]), _level(_count),
+          _local_next(_threads), _blocks(new Block[_threads])
+{
+}
+
+/**
+ * claim_chunk
+ * Take the next chunk of the own block, or steal one from the block of
+ * another thread. Returns false once all chunks of the level are taken.
+ */
+template <typename Adjacency>
+bool ParallelBfs<Adjacency>::claim_chunk(int worker, long& chunk)
+{
+        for (int offset = 0 ; offset < _threads ; offset++) {
+                Block& block = _blocks[(worker + offset) % _threads];
+                if (block.next.load(std::memory_order_relaxed) >= block.end)
+                        continue;
+                chunk = block.next.fetch_add(1, std::memory_order_relaxed);
+                if (chunk < block.end)
+                        return true;
+        }
+        return false;
+}
+
+template <typename Adjacency>
+void ParallelBfs<Adjacency>::expand(int worker, int depth)
+{
+        std::vector<int>& next = _local_next[worker];
+        long size = static_cast<long>(_frontier.size());
+        long chunk;
+
+        next.clear();
+        while (claim_chunk(worker, chunk)) {
+                long end = std::min(size, (chunk + 1) * chunk_size);
+                for (long index = chunk * chunk_size ; index < end ; index++) {
+                        int vertex = _frontier[index];
+                        _out.for_each(vertex, [&](int adj) {
+                                int expected = undiscovered;
+                                if (_parent[adj].load(
+                                        std::memory_order_relaxed) !=
+                                    undiscovered)
+                                        return;
+                                if (!_parent[adj].compare_exchange_strong(
+                                        expected, vertex,
+                                        std::memory_order_relaxed))
+                                        return;
+                                _level[adj] = depth;
+                                next.push_back(adj);
+                        });
+                }
+        }
+}
+
+/**
+ * run
+ * Search from `source` until the level containing `goal` is complete, or
+ * through the whole component of `source` when `goal` is -1.
+ */
+template <typename Adjacency>
+void ParallelBfs<Adjacency>::run(int source, int goal)
+{
+        std::vector<long> offsets(_threads + 1, 0);
+        _frontier.assign(1, source);
+
+        bool done = goal == source;
+        Barrier barrier(_threads);
+        auto split_frontier = [&]() {
+                long chunks = (static_cast<long>(_frontier.size()) +
+                               chunk_size - 1) / chunk_size;
+                for (int worker = 0 ; worker < _threads ; worker++) {
+                        _blocks[worker].next.store(chunks * worker / _threads);
+                        _blocks[worker].end = chunks * (worker + 1) / _threads;
+                }
+        };
+        auto work = [&](int worker) {
+                /* every thread resets its own slice of the arrays */
+                int first = static_cast<int>(static_cast<long>(_count) *
+                                             worker / _threads);
+                int last = static_cast<int>(static_cast<long>(_count) *
+                                            (worker + 1) / _threads);
+                for (int vertex = first ; vertex < last ; vertex++) {
+                        _parent[vertex].store(undiscovered,
+                                              std::memory_order_relaxed);
+                        _level[vertex] = -1;
+                }
+                if (source >= first && source < last) {
+                        _parent[source].store(-1, std::memory_order_relaxed);
+                        _level[source] = 0;
+                }
+                for (int depth = 1 ; ; depth++) {
+                        barrier.wait();
+                        if (done)
+                                break;
+                        expand(worker, depth);
+                        barrier.wait();
+                        if (worker == 0) {
+                                for (int index = 0 ; index < _threads ;
+                                     index++) {
+                                        offsets[index + 1] = offsets[index] +
+                                                _local_next[index].size();
+                                }
+                                _frontier.resize(offsets[_threads]);
+                                split_frontier();
+                                done = _frontier.empty() ||
+                                        (goal >= 0 && visited(goal));
+                        }
+                        barrier.wait();
+                        std::copy(_local_next[worker].begin(),
+                                  _local_next[worker].end(),
+                                  _frontier.begin() + offsets[worker]);
+                }
+        };
+
+        split_frontier();
+        std::vector<std::thread> workers;
+        for (int worker = 1 ; worker < _threads ; worker++) {
+                workers.push_back(std::thread(work, worker));
+        }
+        work(0);
+        for (auto& thread : workers) {
+                thread.join();
+        }
+}
+
+template <typename Adjacency>
+std::vector<int> ParallelBfs<Adjacency>::path(int goal) const
+{
+        std::vector<int> result;
+        if (goal < 0 || !visited(goal))
+                return result;
+        for (int next = goal ; next >= 0 ; next = parent(next)) {
+                result.push_back(next);
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+}
+
+template class ParallelBfs<CsrGraph>;
+template class ParallelBfs<BitMatrix>;
+} /* namespace ascii_graph */
@@ -15,263 +15,576 @@
  * You should have received a copy of the GNU Affero General Public License
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <typeinfo>
-#include <boost/regex.hpp>
+#include <thread>
 #include "parser.h"
+#include "parallel_bfs.h"
+#include "mapped_file.h"
 
-using submatch_value = const boost::match_results
-                        <__gnu_cxx::__normal_iterator
-                                <const char*, std::__cxx11::basic_string<char> >
-                        >;
+namespace ascii_graph {
 
-static char submatch_to_char(submatch_value sm)
+bool DotParser::open_dot_file()
 {
-        auto val = sm;
-        std::string s = val[0];
-        return s.at(0);
+        if (_path.empty())
+                return false;
+
+        _file.open(_path, std::ios::in | std::ios::binary);
+        if (!_file)
+                return false;
+
+        return true;
 }
 
-static int get_vertex_index(char vertex, std::vector<char> vertices)
+bool DotParser::accept(TokenType type)
 {
-        auto it = std::find(vertices.begin(), vertices.end(), vertex);
-        if (it == vertices.end())
-                return -1;
-        return it - vertices.begin();
+        if (_token.type != type)
+                return false;
+        advance();
+        return true;
 }
 
-/*
- * match any character that is preceeded by a
- * tab/space/opening curly bracket and followed by a
- * semi-colon/space/closing curly bracket
- */
-static auto const char_regex = boost::regex(
-        "(?<=\\t|\\s|\\{)\\w(?=\\;|\\s|\\})"
-);
-
-namespace ascii_graph {
-
-bool DotParser::open_dot_file()
+bool DotParser::error(const char* expected)
 {
-        if (_path.empty())
+        /* pieces on worker threads fail silently, see parse_parallel */
+        if (_chunk)
                 return false;
+        std::cerr << "ERROR: Invalid DOT syntax in line " << _token.line
+                  << ": expected " << expected << ", got ";
+        if (_token.type == TokenType::End)
+                std::cerr << "the end of the input." << std::endl;
+        else
+                std::cerr << "'" << std::string(_token.text, _token.length)
+                          << "'." << std::endl;
+        return false;
+}
 
-        _file.open(_path, std::ios::in);
-        if (!_file)
-                return false;
+/**
+ * parse_header
+ * header : [strict] (graph | digraph) [ID] '{'
+ */
+bool DotParser::parse_header()
+{
+        if (token_is_keyword(_token, "strict"))
+                advance();
+        if (token_is_keyword(_token, "digraph"))
+                _directed = true;
+        else if (!token_is_keyword(_token, "graph"))
+                return error("'graph' or 'digraph'");
+        advance();
+        if (_token.type == TokenType::Identifier)
+                advance();
+        if (!accept(TokenType::LeftBrace))
+                return error("'{'");
+        return true;
+}
+
+/**
+ * parse_statements
+ * Parse top level statements until the end of the piece or the closing
+ * brace of the graph.
+ */
+bool DotParser::parse_statements()
+{
+        while (_token.type != TokenType::End &&
+               _token.type != TokenType::RightBrace) {
+                if (!parse_stmt())
+                        return false;
+                accept(TokenType::Semicolon);
+                _mentioned.clear();
+        }
+        return true;
+}
 
+/**
+ * parse_footer
+ * footer : '}' <end of input>
+ */
+bool DotParser::parse_footer()
+{
+        if (!accept(TokenType::RightBrace))
+                return error("'}'");
+        if (_token.type != TokenType::End)
+                return error("the end of the input");
         return true;
 }
 
-void DotParser::read_content()
+/**
+ * parse_stmt_list
+ * stmt_list : [stmt [';'] stmt_list]
+ */
+bool DotParser::parse_stmt_list()
 {
-        std::string line;
-        if (_file.is_open()) {
-                while (std::getline(_file, line)) {
-                        _content.push_back(line);
-                }
-                _file.close();
+        while (_token.type != TokenType::RightBrace) {
+                if (_token.type == TokenType::End)
+                        return error("'}'");
+                if (!parse_stmt())
+                        return false;
+                accept(TokenType::Semicolon);
         }
+        return true;
 }
 
 /**
- * is_dot_format
- * Perform basic checks to determine if the file contains a DOT-format.
- *
- * The file should start with a declaration of the type of graph:
- * (directed = digraph | undirected = graph), followed by an opening
- * curly bracket ('{'). The lines in between those brackets are terminated
- * by an semicolon (';'). And the file has to end with a matching closing
- * curly bracket ('}').
- * This method expects that the _content variable is filled by read_content
- * before a call to this method.
+ * parse_stmt
+ * stmt : (graph | node | edge) attr_list
+ *      | ID '=' ID
+ *      | (node_id | subgraph) [edgeRHS] [attr_list]
  */
-bool DotParser::is_dot_format()
+bool DotParser::parse_stmt()
 {
-        if (_content.empty()) {
-                std::cerr << "ERROR: Call `read_content` before checking"
-                          << " the file format." << std::endl;
-                return false;
+        if (token_is_keyword(_token, "graph") ||
+            token_is_keyword(_token, "node") ||
+            token_is_keyword(_token, "edge")) {
+                bool edge = token_is_keyword(_token, "edge");
+                advance();
+                if (_token.type != TokenType::LeftBracket)
+                        return error("'['");
+                return parse_attr_list(edge ? &_edge_weight : nullptr);
         }
-        /* Search patterns */
-        auto const dot_header_pattern = boost::regex("(digraph|graph) \\w* {");
-        auto const close_bracket = boost::regex("}");
-        auto const end_semicol = boost::regex(".*;$");
-        int index = 0;
-        bool closed = false;
-        for (auto& line : _content) {
-                /* skip comments */
-                if (line.rfind("//", 0) == 0)
-                        continue;
-                if (index++ == 0) {
-                        if (!boost::regex_match(line, dot_header_pattern)) {
-                                std::cerr << "ERROR: Dot-format header doesn't"
-                                          << " match: " << std::endl
-                                          << "got: " << line << std::endl
-                                          << "expected: (digraph|graph) * {"
-                                          << std::endl;
-                                return false;
-                        }
-                } else {
-                        if (boost::regex_match(line, close_bracket)) {
-                                closed = true;
-                                break;
-                        }
-                        if (!boost::regex_match(line, end_semicol)) {
-                                std::cout << "DEBUG: no semicol" << std::endl;
-                                std::cerr << "ERROR: Each line inbetween '{}'"
-                                          << " has to end with an ';'."
-                                          << std::endl
-                                          << "got: " << line << std::endl;
-                                return false;
-                        }
+
+        std::size_t pending = _pending.size();
+        std::size_t first = _mentioned.size();
+        std::size_t last;
+        if (_token.type == TokenType::Identifier &&
+            !token_is_keyword(_token, "subgraph")) {
+                Token id = _token;
+                advance();
+                if (accept(TokenType::Equals)) {
+                        if (!accept(TokenType::Identifier))
+                                return error("an ID");
+                        return true;
                 }
+                _mentioned.push_back(add_vertex(id.text, id.length));
+                last = _mentioned.size();
+                if (!parse_port())
+                        return false;
+        } else if (!parse_operand(first, last)) {
+                return false;
         }
-        if (!closed) {
-                std::cerr << "ERROR: File needs to end with an '}'"
-                          << std::endl;
+
+        if (!parse_edge_rhs(first, last))
+                return false;
+        float weight = _edge_weight;
+        if (_token.type == TokenType::LeftBracket &&
+            !parse_attr_list(&weight))
                 return false;
+        for (std::size_t index = pending ; index < _pending.size() ; index++) {
+                add_edge(_pending[index].first, _pending[index].second,
+                         weight);
         }
+        _pending.resize(pending);
         return true;
 }
 
+static bool is_weight_attribute(const Token& token)
+{
+        return (token.length == 6 &&
+                std::memcmp(token.text, "weight", 6) == 0) ||
+               (token.length == 3 && std::memcmp(token.text, "len", 3) == 0);
+}
+
 /**
- * get_syntax_lines
- * Fetch all lines from the DOT-Parser inbetween the curly braces.
+ * parse_attr_list
+ * attr_list : '[' [ID ['=' ID] [';' | ','] ...] ']' [attr_list]
+ *
+ * When `weight` is set, the value of a `weight` or `len` attribute is
+ * stored in it, the last one given wins.
  */
-void DotParser::get_syntax_lines()
+bool DotParser::parse_attr_list(float* weight)
 {
-        auto const start_bracket = boost::regex(".* {");
-        auto const end_bracket = boost::regex("}");
-        bool start_syntax = false;
-
-        for (auto& line : _content) {
-                if (!start_syntax) {
-                        if (!boost::regex_match(line, start_bracket))
-                                continue;
-                        start_syntax = true;
-                        continue;
+        while (accept(TokenType::LeftBracket)) {
+                while (!accept(TokenType::RightBracket)) {
+                        Token name = _token;
+                        if (!accept(TokenType::Identifier))
+                                return error("an attribute or ']'");
+                        if (accept(TokenType::Equals)) {
+                                if (weight && is_weight_attribute(name) &&
+                                    !parse_weight(weight))
+                                        return false;
+                                if (!accept(TokenType::Identifier))
+                                        return error("an attribute value");
+                        }
+                        if (!accept(TokenType::Semicolon))
+                                accept(TokenType::Comma);
                 }
-                if (boost::regex_match(line, end_bracket))
-                        break;
-                _syntax_lines.push_back(line);
         }
+        return true;
 }
 
 /**
- * get_vertices
- * Search for a unique set of vertices within the DOT-format.
- *
- * Currently only checks for characters and doesn't care about
- * any attributes like labels.
+ * parse_weight
+ * Convert the current token to an edge weight, without consuming it.
  */
-std::vector<char> DotParser::get_vertices()
+bool DotParser::parse_weight(float* weight)
 {
-        std::vector<char> vertices;
-
-        for (auto& line : _syntax_lines) {
-                boost::sregex_iterator i(line.begin(), line.end(), char_regex);
-                boost::sregex_iterator j;
-                if (i == j) {
-                        std::cout << "WARNING: No upper/lower-case character"
-                                  << " located within: " << line << std::endl;
-                }
+        if (_token.type != TokenType::Identifier)
+                return error("an attribute value");
+        std::string text(_token.text, _token.length);
+        char* end;
+        double value = std::strtod(text.c_str(), &end);
+        if (text.empty() || *end != '\0' || !(value >= 0))
+                return error("a non-negative weight");
+        *weight = static_cast<float>(value);
+        return true;
+}
 
-                while (i != j) {
-                        char c = submatch_to_char(*i++);
-                        if (std::find(vertices.begin(), vertices.end(), c)
-                            != vertices.end())
-                                continue;
-                        vertices.push_back(c);
-                }
+/**
+ * parse_port
+ * port : ':' ID [':' compass_pt]
+ */
+bool DotParser::parse_port()
+{
+        while (accept(TokenType::Colon)) {
+                if (!accept(TokenType::Identifier))
+                        return error("a port");
         }
-        return vertices;
+        return true;
 }
 
-std::vector< std::pair<int, int> > DotParser::get_links(std::vector<char> vert)
+/**
+ * parse_subgraph
+ * subgraph : [subgraph [ID]] '{' stmt_list '}'
+ */
+bool DotParser::parse_subgraph()
 {
-        std::vector< std::pair<int, int> > links;
-
-        auto const undir_link = boost::regex(
-                "(?<=\\t\\w | \\w )--(?= \\w;| \\w )");
-
-        for (auto& line : _syntax_lines) {
-                boost::sregex_iterator v(line.begin(), line.end(), char_regex);
-                boost::sregex_iterator ul(line.begin(), line.end(), undir_link);
-                boost::sregex_iterator e;
-
-                int link_count = 0;
-                int index_1, index_2;
-                char c;
-                while (v != e) {
-                        if (link_count == 0) {
-                                c = submatch_to_char(*v++);
-                                index_1 = get_vertex_index(c, vert);
-                        } else {
-                                index_1 = index_2;
-                        }
-                        if (ul++ != e) {
-                                if (v != e) {
-                                        c = submatch_to_char(*v++);
-                                        index_2 = get_vertex_index(c, vert);
-                                        links.push_back(
-                                                std::make_pair(index_1, index_2)
-                                        );
-                                        link_count++;
-                                }
+        if (token_is_keyword(_token, "subgraph")) {
+                advance();
+                if (_token.type == TokenType::Identifier)
+                        advance();
+        }
+        if (!accept(TokenType::LeftBrace))
+                return error("'{'");
+        /* attribute statements only apply within the subgraph */
+        float edge_weight = _edge_weight;
+        if (!parse_stmt_list())
+                return false;
+        _edge_weight = edge_weight;
+        if (!accept(TokenType::RightBrace))
+                return error("'}'");
+        return true;
+}
+
+/**
+ * parse_operand
+ * Parse a node ID or a subgraph, the vertices it stands for are
+ * `_mentioned[first] .. _mentioned[last - 1]`.
+ */
+bool DotParser::parse_operand(std::size_t& first, std::size_t& last)
+{
+        first = _mentioned.size();
+        if (_token.type == TokenType::Identifier &&
+            !token_is_keyword(_token, "subgraph")) {
+                _mentioned.push_back(add_vertex(_token.text,
+                                                _token.length));
+                last = _mentioned.size();
+                advance();
+                return parse_port();
+        }
+        if (_token.type != TokenType::LeftBrace &&
+            !token_is_keyword(_token, "subgraph"))
+                return error("a node ID or a subgraph");
+
+        if (!parse_subgraph())
+                return false;
+        last = _mentioned.size();
+        return true;
+}
+
+/**
+ * parse_edge_rhs
+ * edgeRHS : edgeop (node_id | subgraph) [edgeRHS]
+ *
+ * Link every vertex of an operand with every vertex of the next one, in a
+ * digraph the arcs lead from the left operand to the right one. The first
+ * operand is `_mentioned[first] .. _mentioned[last - 1]`. The edges are
+ * queued in `_pending` until the attributes of the statement are known.
+ */
+bool DotParser::parse_edge_rhs(std::size_t first, std::size_t last)
+{
+        std::size_t next_first, next_last;
+        while (_token.type == TokenType::UndirectedEdge ||
+               _token.type == TokenType::DirectedEdge) {
+                if (_directed && _token.type == TokenType::UndirectedEdge)
+                        return error("'->'");
+                if (!_directed && _token.type == TokenType::DirectedEdge)
+                        return error("'--'");
+                advance();
+                if (!parse_operand(next_first, next_last))
+                        return false;
+                for (std::size_t from = first ; from < last ; from++) {
+                        for (std::size_t to = next_first ; to < next_last ;
+                             to++) {
+                                _pending.push_back(std::make_pair(
+                                        _mentioned[from], _mentioned[to]));
                         }
                 }
+                first = next_first;
+                last = next_last;
         }
+        return true;
+}
 
-        return links;
+void DotParser::reset_state(Graph* graph)
+{
+        _graph = graph;
+        _mentioned.clear();
+        _pending.clear();
+        _edges.clear();
+        _line = 1;
+        _directed = false;
+        _edge_weight = 1;
+        _parallel_pieces = 0;
 }
 
-bool DotParser::parse(std::string path, Graph* graph)
+bool DotParser::finish(bool parsed)
 {
-        _path = path;
-        if (!open_dot_file()) {
-                std::cerr << "ERROR: Failed to open the file at "
-                          << path << " ." << std::endl;
+        flush_edges();
+        _graph->freeze();
+        if (parsed && _graph->empty()) {
+                std::cerr << "ERROR: The graph contains no vertices."
+                          << std::endl;
                 return false;
         }
-        read_content();
+        return parsed;
+}
 
-        if (!is_dot_format()) {
-                std::cerr << "ERROR: File at " << _path
-                          << " contains no valid DOT format."
-                          << std::endl;
-                _file.close();
+/**
+ * parse_piece
+ * Parse a piece of the input that ends between two top level statements.
+ * The `first` piece starts with the header, the `last` one ends with the
+ * closing brace.
+ */
+bool DotParser::parse_piece(const char* begin, const char* end, bool first,
+                            bool last)
+{
+        _lexer.reset(begin, end, _line, first);
+        advance();
+        if (first && !parse_header())
                 return false;
-        }
+        if (!parse_statements())
+                return false;
+        if (last)
+                return parse_footer();
+        if (_token.type != TokenType::End)
+                return error("a statement");
+        _line = _lexer.line();
+        return true;
+}
+
+int DotParser::add_vertex(const char* name, std::size_t length)
+{
+        if (_chunk)
+                return _chunk->names.intern(name, length);
+        return _graph->create_vertex(name, length);
+}
 
-        get_syntax_lines();
+void DotParser::add_edge(int from, int to, float weight)
+{
+        Arc edge = { from, to, weight };
+        if (_chunk)
+                _chunk->edges.push_back(edge);
+        else
+                _edges.push_back(edge);
+}
 
-        std::vector<char> vertices = get_vertices();
-        if (vertices.empty()) {
-                std::cerr << "ERROR: Invalid graph nodes, use single "
-                          << "characters." << std::endl;
-                _file.close();
+/* Link the buffered edges, the ids of their vertices are final */
+void DotParser::flush_edges()
+{
+        _graph->add_edges(_edges, _directed);
+        _edges.clear();
+}
+
+bool DotParser::parse_buffer(const char* begin, const char* end)
+{
+        /* below this size threads cost more than they save */
+        const std::size_t parallel_size = 1 << 20;
+        int threads = _threads > 0 ? _threads : default_thread_count();
+        if (threads > 1 && static_cast<std::size_t>(end - begin) >=
+            parallel_size)
+                return finish(parse_parallel(begin, end, threads));
+        return finish(parse_piece(begin, end, true, true));
+}
+
+/**
+ * parse_parallel
+ * Cut the statements of the graph body into one piece per thread and parse
+ * the pieces concurrently.
+ *
+ * Every worker collects the names it meets in a local symbol table, in the
+ * order of their first appearance, and the edges in a local buffer. The
+ * pieces are merged in input order, so the vertices get the same ids as in
+ * a sequential parse, and all edges are added in bulk once the number of
+ * them is known. If any piece fails, the buffer is parsed again
+ * sequentially to report the error. The same happens when a piece changes
+ * the default edge weight for the pieces after it.
+ */
+bool DotParser::parse_parallel(const char* begin, const char* end,
+                               int threads)
+{
+        std::size_t size = end - begin;
+        StatementSplitter splitter;
+        std::vector<std::size_t> cuts(1, 0);
+        /* the header and the first statements form a short piece, parsed on
+         * this thread before the workers start */
+        std::size_t cut = 0;
+        for (std::size_t limit = 256 ; cut == 0 && limit < size ; limit *= 2) {
+                cut = splitter.scan(begin, limit);
+        }
+        if (cut == 0)
+                return parse_piece(begin, end, true, true);
+        cuts.push_back(cut);
+        for (int piece = 1 ; piece < threads ; piece++) {
+                cut = splitter.scan(begin, size * piece / threads);
+                if (cut > cuts.back())
+                        cuts.push_back(cut);
+        }
+        cuts.push_back(size);
+
+        if (!parse_piece(begin, begin + cuts[1], true, false))
                 return false;
+
+        int pieces = static_cast<int>(cuts.size()) - 2;
+        std::vector<Chunk> chunks(pieces);
+        std::vector<char> parsed(pieces, 0);
+        std::vector<char> local(pieces, 1);
+        std::vector<std::thread> workers;
+        for (int piece = 0 ; piece < pieces ; piece++) {
+                workers.push_back(std::thread([&, piece]() {
+                        DotParser worker;
+                        worker._chunk = &chunks[piece];
+                        worker._directed = _directed;
+                        worker._edge_weight = _edge_weight;
+                        parsed[piece] = worker.parse_piece(
+                                begin + cuts[piece + 1],
+                                begin + cuts[piece + 2], false,
+                                piece == pieces - 1);
+                        local[piece] = worker._edge_weight == _edge_weight;
+                }));
+        }
+        for (auto& worker : workers) {
+                worker.join();
         }
 
-        for (auto& vertex : vertices) {
-                graph->create_vertex(vertex);
+        if (std::find(parsed.begin(), parsed.end(), 0) != parsed.end()) {
+                std::cerr << "WARNING: Parallel parse failed, parsing "
+                          << "again to locate the error." << std::endl;
+                reset_state(_graph);
+                return parse_piece(begin, end, true, true);
+        }
+        if (std::find(local.begin(), local.end() - 1, 0) != local.end() - 1) {
+                reset_state(_graph);
+                return parse_piece(begin, end, true, true);
         }
 
-        std::vector< std::pair<int, int> > links = get_links(vertices);
-        if (links.empty()) {
-                std::cerr << "ERROR: Invalid syntax within the DOT-format at '"
-                          << path << "' ." << std::endl;
-                _file.close();
-                return false;
+        std::vector<int> global;
+        std::size_t edges = _edges.size();
+        for (auto& chunk : chunks) {
+                int count = chunk.names.size();
+                global.resize(count);
+                for (int id = 0 ; id < count ; id++) {
+                        global[id] = _graph->create_vertex(
+                                chunk.names.data(id), chunk.names.length(id));
+                }
+                for (auto& edge : chunk.edges) {
+                        edge.from = global[edge.from];
+                        edge.to = global[edge.to];
+                }
+                edges += chunk.edges.size();
+        }
+        _graph->reserve(_graph->vertices(), edges, _directed);
+        flush_edges();
+        for (auto& chunk : chunks) {
+                _graph->add_edges(chunk.edges, _directed);
+                std::vector<Arc>().swap(chunk.edges);
         }
+        _parallel_pieces = pieces;
+        return true;
+}
+
+/**
+ * parse_stream
+ * Parse a DOT graph from `input` while it is read.
+ *
+ * The input is read in blocks, every run of complete statements is parsed
+ * and dropped from the buffer right away. With statements terminated by
+ * ';' the memory used is bounded by the block size plus the longest
+ * statement.
+ */
+bool DotParser::parse_stream(std::istream& input, Graph* graph)
+{
+        const std::size_t block_size = 1 << 16;
+        std::vector<char> block(block_size);
+        StatementSplitter splitter;
+        std::string buffer;
+        bool first = true;
 
-        for (auto& link : links) {
-                graph->link_two_vertices_undirected(link.first, link.second);
+        reset_state(graph);
+        while (input.read(block.data(), block_size) || input.gcount()) {
+                buffer.append(block.data(), input.gcount());
+                std::size_t cut = splitter.scan(buffer.data(), buffer.size());
+                if (cut == 0)
+                        continue;
+                if (!parse_piece(buffer.data(), buffer.data() + cut, first,
+                                 false))
+                        return finish(false);
+                flush_edges();
+                first = false;
+                buffer.erase(0, cut);
+                splitter.consumed(cut);
         }
+        return finish(parse_piece(buffer.data(),
+                                  buffer.data() + buffer.size(), first, true));
+}
 
-        _file.close();
+/**
+ * parse_content
+ * Parse a DOT graph held in memory into `graph`.
+ */
+bool DotParser::parse_content(const std::string& content, Graph* graph)
+{
+        reset_state(graph);
+        return parse_buffer(content.data(), content.data() + content.size());
+}
+
+/**
+ * parse
+ * Parse the DOT file at `path` into `graph`.
+ *
+ * Regular files are memory mapped and parsed in place, the only copies
+ * made are the interned vertex names. Other files (pipes) are parsed as a
+ * stream, a `path` of "-" reads the standard input.
+ */
+bool DotParser::parse(std::string path, Graph* graph)
+{
+        _path = path;
+
+        bool parsed;
+        MappedFile mapping;
+        if (_path == "-") {
+                parsed = parse_stream(std::cin, graph);
+        } else if (mapping.open(_path)) {
+                reset_state(graph);
+                parsed = parse_buffer(mapping.begin(), mapping.end());
+        } else {
+                if (!open_dot_file()) {
+                        std::cerr << "ERROR: Failed to open the file at "
+                                  << path << " ." << std::endl;
+                        return false;
+                }
+                parsed = parse_stream(_file, graph);
+                _file.close();
+        }
+
+        if (!parsed) {
+                std::cerr << "ERROR: File at " << _path
+                          << " contains no valid DOT format."
+                          << std::endl;
+                return false;
+        }
         return true;
 }
 } /* namespace ascii_graph */
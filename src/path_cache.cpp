@@ -0,0 +1,163 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include "path_cache.h"
+
+namespace ascii_graph {
+PathCache::PathCache(std::size_t paths, std::size_t trees)
+        : _path_capacity(paths), _tree_capacity(trees)
+{
+}
+
+/**
+ * set_capacity
+ * Limit the number of cached paths and BFS trees, 0 disables either
+ * cache. A tree takes an int per vertex of the graph.
+ */
+void PathCache::set_capacity(std::size_t paths, std::size_t trees)
+{
+        _path_capacity = paths;
+        _tree_capacity = trees;
+        trim();
+}
+
+/* Drop the entries of an older graph `version` */
+void PathCache::validate(unsigned long version)
+{
+        if (version == _version)
+                return;
+        clear();
+        _version = version;
+}
+
+void PathCache::clear()
+{
+        _paths.clear();
+        _path_index.clear();
+        _trees.clear();
+        _candidates.clear();
+}
+
+/* Evict the least recently used entries beyond the capacities */
+void PathCache::trim()
+{
+        while (_paths.size() > _path_capacity) {
+                _path_index.erase(_paths.back().first);
+                _paths.pop_back();
+        }
+        while (_trees.size() > _tree_capacity) {
+                _trees.pop_back();
+        }
+        while (_candidates.size() > _tree_capacity * candidates_per_tree) {
+                _candidates.pop_back();
+        }
+}
+
+/**
+ * find_path
+ * Returns the cached path or null, a hit makes the entry the most recently
+ * used one.
+ */
+const std::vector<int>* PathCache::find_path(int source, int goal,
+                                             int algorithm)
+{
+        Key key = { source, goal, algorithm };
+        auto found = _path_index.find(key);
+        if (found == _path_index.end()) {
+                _stats.path_misses++;
+                return nullptr;
+        }
+        _stats.path_hits++;
+        _paths.splice(_paths.begin(), _paths, found->second);
+        return &found->second->second;
+}
+
+void PathCache::store_path(int source, int goal, int algorithm,
+                           const std::vector<int>& path)
+{
+        if (_path_capacity == 0)
+                return;
+        Key key = { source, goal, algorithm };
+        auto found = _path_index.find(key);
+        if (found != _path_index.end()) {
+                found->second->second = path;
+                _paths.splice(_paths.begin(), _paths, found->second);
+                return;
+        }
+        _paths.push_front(PathEntry(key, path));
+        _path_index[key] = _paths.begin();
+        trim();
+}
+
+/**
+ * find_tree
+ * Returns the parent array of the BFS tree of `source` or null. On a miss
+ * `wanted` tells whether the source missed recently and the caller should
+ * search the complete tree and store it.
+ */
+const std::vector<int>* PathCache::find_tree(int source, bool& wanted)
+{
+        wanted = false;
+        if (_tree_capacity == 0)
+                return nullptr;
+        for (auto entry = _trees.begin() ; entry != _trees.end() ; ++entry) {
+                if (entry->first != source)
+                        continue;
+                _stats.tree_hits++;
+                _trees.splice(_trees.begin(), _trees, entry);
+                return &_trees.front().second;
+        }
+        _stats.tree_misses++;
+        auto candidate = std::find(_candidates.begin(), _candidates.end(),
+                                   source);
+        wanted = candidate != _candidates.end();
+        if (wanted)
+                _candidates.erase(candidate);
+        else
+                _candidates.push_front(source);
+        trim();
+        return nullptr;
+}
+
+void PathCache::store_tree(int source, const int* parents, int count)
+{
+        if (_tree_capacity == 0)
+                return;
+        _trees.push_front(TreeEntry(source, std::vector<int>()));
+        _trees.front().second.assign(parents, parents + count);
+        trim();
+}
+
+/**
+ * tree_path
+ * Walk the `parents` of a BFS tree rooted at `source` from `goal` back to
+ * the root. Returns an empty path when `goal` isn't part of the tree.
+ */
+std::vector<int> tree_path(const std::vector<int>& parents, int source,
+                           int goal)
+{
+        std::vector<int> path;
+        if (goal != source && parents[goal] < 0)
+                return path;
+        for (int next = goal ; next >= 0 ; next = parents[next]) {
+                path.push_back(next);
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+}
+} /* namespace ascii_graph */
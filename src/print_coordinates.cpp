@@ -15,9 +15,39 @@
  * You should have received a copy of the GNU Affero General Public License
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <queue>
 #include "print_coordinates.h"
 
 namespace ascii_graph {
+/**
+ * PrintCoordinates
+ * Lay out the drawing of `graph`, which is read in place and has to stay
+ * unmodified while printing. The arcs are drawn without their direction.
+ */
+PrintCoordinates::PrintCoordinates(const GraphView& graph,
+                                   const Layout& layout)
+        : _graph(graph), _layout(layout)
+{
+        /* every column is as wide as the longest name + 4 */
+        std::size_t width = 1;
+        for (int index = 0 ; index < _graph.vertices() ; index++) {
+                width = std::max(width, _graph.names().length(index));
+        }
+        _width = static_cast<int>(width) + 4;
+        _connect = std::string(_width - 1, '-');
+        _space = std::string(_width - 1, ' ');
+        _order.resize(_graph.vertices());
+        std::iota(_order.begin(), _order.end(), 0);
+        _column = _order;
+        if (_layout.reorder)
+                order_columns();
+        get_edges_with_min_distance();
+}
+
 bool sort_by_distance(std::tuple<int, int, int> edge1,
                       std::tuple<int, int, int> edge2)
 {
@@ -25,131 +55,282 @@ bool sort_by_distance(std::tuple<int, int, int> edge1,
                 (std::get<1>(edge2) - std::get<0>(edge2));
 }
 
-void PrintCoordinates::get_edges_with_min_distance()
+/* the vertices linked to `vertex` in either direction, ascending */
+void PrintCoordinates::linked_vertices(int vertex, std::vector<int>& linked)
 {
-        int row_index = 0;
-        for (auto& row : _adj_matrix) {
-                int col_index = 0;
-                for (auto& col : row) {
-                        if (col == 1 && col_index > row_index + 1) {
-                                _edges.push_back(std::make_tuple(row_index,
-                                                                 col_index,
-                                                                 0));
+        NeighborRange out = _graph.neighbors(vertex);
+        NeighborRange in = _graph.in_neighbors(vertex);
+        linked.clear();
+        std::set_union(out.begin(), out.end(), in.begin(), in.end(),
+                       std::back_inserter(linked));
+}
+
+/* number of columns covered by all edges, the self loops cover none */
+long PrintCoordinates::span()
+{
+        std::vector<int> linked;
+        long total = 0;
+        for (int vertex = 0 ; vertex < _graph.vertices() ; vertex++) {
+                linked_vertices(vertex, linked);
+                for (auto& adj : linked) {
+                        if (adj > vertex)
+                                total += std::abs(_column[adj] -
+                                                  _column[vertex]);
+                }
+        }
+        return total;
+}
+
+/**
+ * order_columns
+ * Order the columns by a reverse Cuthill-McKee sweep: a BFS through every
+ * component from a vertex of the lowest degree, which visits the linked
+ * vertices by rising degree. The order is kept when it shortens the edges.
+ */
+void PrintCoordinates::order_columns()
+{
+        int count = _graph.vertices();
+        std::vector<int> degree(count);
+        std::vector<int> linked;
+        for (int vertex = 0 ; vertex < count ; vertex++) {
+                linked_vertices(vertex, linked);
+                degree[vertex] = static_cast<int>(linked.size());
+        }
+        auto by_degree = [&](int one, int two) {
+                return degree[one] < degree[two] ||
+                        (degree[one] == degree[two] && one < two);
+        };
+        std::vector<int> starts(_order);
+        std::sort(starts.begin(), starts.end(), by_degree);
+
+        std::vector<int> order;
+        order.reserve(count);
+        std::vector<char> placed(count, 0);
+        for (auto& start : starts) {
+                if (placed[start])
+                        continue;
+                placed[start] = 1;
+                order.push_back(start);
+                for (std::size_t index = order.size() - 1 ;
+                     index < order.size() ; index++) {
+                        linked_vertices(order[index], linked);
+                        std::sort(linked.begin(), linked.end(), by_degree);
+                        for (auto& adj : linked) {
+                                if (placed[adj])
+                                        continue;
+                                placed[adj] = 1;
+                                order.push_back(adj);
                         }
-                        col_index++;
                 }
-                row_index++;
         }
+        std::reverse(order.begin(), order.end());
 
-        /* Set the order of the edges for printing */
-        sort(_edges.begin(), _edges.end(), sort_by_distance);
-        int row_count = 0;
-        for (auto& edge : _edges) {
-                std::get<2>(edge) = row_count++;
+        long before = span();
+        std::vector<int> column(count);
+        for (int col = 0 ; col < count ; col++) {
+                column[order[col]] = col;
+        }
+        column.swap(_column);
+        if (span() < before) {
+                _order.swap(order);
+        } else {
+                column.swap(_column);
         }
 }
 
-void PrintCoordinates::print_head()
+void PrintCoordinates::get_edges_with_min_distance()
 {
-        for (auto it = std::begin(_vertices); it != std::end(_vertices); ++it) {
-                std::cout << *it;
-                int index = it - _vertices.begin();
-                if (it != _vertices.end()-1) {
-                        if (_adj_matrix[index][index + 1] == 1)
-                                std::cout << _connect;
-                        else
-                                std::cout << _space;
+        /* the edges between columns that aren't neighbors, each from the
+         * side of its left column */
+        std::vector<int> linked;
+        for (int vertex = 0 ; vertex < _graph.vertices() ; vertex++) {
+                linked_vertices(vertex, linked);
+                int row = _column[vertex];
+                for (auto& adj : linked) {
+                        int col = _column[adj];
+                        if (col > row + 1)
+                                _edges.push_back(std::make_tuple(row, col,
+                                                                 0));
                 }
         }
-        std::cout << std::endl;
-        get_edges_with_min_distance();
+
+        if (_layout.pack) {
+                pack_rows();
+        } else {
+                /* Set the order of the edges for printing, edge `order`
+                 * is drawn in row 2 * order + 1 */
+                sort(_edges.begin(), _edges.end(), sort_by_distance);
+                int row_count = 0;
+                for (auto& edge : _edges) {
+                        std::get<2>(edge) = row_count++;
+                }
+        }
+        int edge_index = 0;
+        int edge_count = static_cast<int>(_edges.size());
+        int row_count = edge_count ? std::get<2>(_edges.back()) + 1 : 0;
+        _row_begin.resize(row_count + 1);
+        for (int row = 0 ; row <= row_count ; row++) {
+                while (edge_index < edge_count &&
+                       std::get<2>(_edges[edge_index]) < row) {
+                        edge_index++;
+                }
+                _row_begin[row] = edge_index;
+        }
+
+        /* the edges of row k are drawn in row 2 * k + 1 and end the lines
+         * of their columns there */
+        _vertical_end.assign(_graph.vertices(), -1);
+        for (auto& edge : _edges) {
+                int edge_row = 2 * std::get<2>(edge) + 1;
+                _vertical_end[std::get<0>(edge)] = std::max(
+                        _vertical_end[std::get<0>(edge)], edge_row);
+                _vertical_end[std::get<1>(edge)] = std::max(
+                        _vertical_end[std::get<1>(edge)], edge_row);
+        }
 }
 
-int PrintCoordinates::print_point(int row, int col)
+/**
+ * pack_rows
+ * Assign the edges to as few rows as possible without overlapping edges in
+ * a row, an edge goes to the row whose last edge ended the earliest, when
+ * that one ended left of it.
+ */
+void PrintCoordinates::pack_rows()
 {
-        int max_col = static_cast<int>(_vertices.size());
+        typedef std::pair<int, int> RowEnd;
+        std::priority_queue<RowEnd, std::vector<RowEnd>,
+                            std::greater<RowEnd> > ends;
+        int row_count = 0;
 
-        if (row > rows()) {
-                std::cout << "invalid row " << row << "edges " << rows()
-                          << std::endl;
-                return 1;
-        }
-        if (col >= max_col) {
-                std::cout << "invalid column " << col << "vertices "
-                          << max_col << std::endl;
-                return 1;
+        std::sort(_edges.begin(), _edges.end());
+        for (auto& edge : _edges) {
+                int row;
+                if (!ends.empty() && ends.top().first < std::get<0>(edge)) {
+                        row = ends.top().second;
+                        ends.pop();
+                } else {
+                        row = row_count++;
+                }
+                std::get<2>(edge) = row;
+                ends.push(RowEnd(std::get<1>(edge), row));
         }
+        std::sort(_edges.begin(), _edges.end(),
+                  [](const std::tuple<int, int, int>& one,
+                     const std::tuple<int, int, int>& two) {
+                return std::get<2>(one) < std::get<2>(two) ||
+                        (std::get<2>(one) == std::get<2>(two) &&
+                         std::get<0>(one) < std::get<0>(two));
+        });
+}
 
-        std::tuple<int, int, int> active_edge = get_active_edge(row);
-        char c = get_char_for_point(row, col);
-        std::cout << c;
-        if (col == max_col - 1) {
-                std::cout << std::endl;
-                return 0;
-        }
-        if (c == '|' || c == ' ') {
-                std::cout << _space;
-                return 0;
+void PrintCoordinates::print_head(OutputSink& sink, int first, int last)
+{
+        const SymbolTable& names = _graph.names();
+        int count = _graph.vertices();
+        if (last < 0)
+                last = count;
+        for (int col = first ; col < last ; col++) {
+                int index = _order[col];
+                sink.write(names.data(index), names.length(index));
+                int fill = _width - static_cast<int>(names.length(index));
+                if (col != count - 1)
+                        sink.fill(_graph.linked(index, _order[col + 1]) ?
+                                  '-' : ' ', fill);
         }
-        if (c == '-' || c == '+') {
-                std::cout << _connect;
-                return 0;
+        sink.put('\n');
+}
+
+/**
+ * print_row
+ * Write the columns `first` .. `last` - 1 of row `row` of the drawing below
+ * the head, 0 .. rows() - 1. The odd rows hold the edges, the even ones
+ * only the vertical lines.
+ */
+void PrintCoordinates::print_row(int row, OutputSink& sink, int first,
+                                 int last)
+{
+        typedef std::tuple<int, int, int> Edge;
+        int max_col = _graph.vertices();
+        if (last < 0)
+                last = max_col;
+        /* the edges of the row, from the first one ending in the window */
+        auto edge = _edges.cbegin();
+        auto row_end = _edges.cbegin();
+        if (row % 2) {
+                row_end += _row_begin[row / 2 + 1];
+                edge = std::lower_bound(
+                        _edges.cbegin() + _row_begin[row / 2], row_end,
+                        first, [](const Edge& one, int col) {
+                        return std::get<1>(one) < col;
+                });
         }
-        if (c == 'O') {
-                if (col < std::get<1>(active_edge))
-                        std::cout << _connect;
+
+        for (int col = first ; col < last ; col++) {
+                if (edge != row_end && std::get<1>(*edge) < col)
+                        ++edge;
+                int active_end = edge != row_end ? std::get<1>(*edge) : -1;
+                char c = get_char_for_point(row, col,
+                                            edge != row_end ?
+                                            std::get<0>(*edge) : -1,
+                                            active_end);
+                sink.put(c);
+                if (col == max_col - 1)
+                        break;
+                if (c == '-' || c == '+' || (c == 'O' && col < active_end))
+                        sink.write(_connect);
                 else
-                        std::cout << _space;
-                return 0;
+                        sink.write(_space);
         }
-        return 1;
+        sink.put('\n');
 }
 
-char PrintCoordinates::get_char_for_point(int row, int col)
+void PrintCoordinates::print(OutputSink& sink)
 {
-        std::tuple<int, int, int> active_edge = get_active_edge(row);
-        char character = ' ';
-
-        /* Is point within the range of the active_edge */
-        if (col >= std::get<0>(active_edge) &&
-            col <= std::get<1>(active_edge)) {
-                int active_edge_start = std::get<0>(active_edge);
-                int active_edge_end = std::get<1>(active_edge);
-                if (active_edge_start == col || active_edge_end == col)
-                        return 'O';
-                character = '-';
-                for (auto& edge : _edges) {
-                        int edge_start = std::get<0>(edge);
-                        int edge_end = std::get<1>(edge);
-                        int edge_row = (std::get<2>(edge) * 2) + 1;
-                        /* Is there any vertical connection intersecting the
-                         * active edge */
-                        if (edge_row > row) {
-                                if (edge_start == col || edge_end == col)
-                                        character = '+';
-                        }
-                }
-                return character;
+        print_head(sink);
+        for (int row = 0 ; row < rows() ; row++) {
+                print_row(row, sink);
         }
-        for (auto& edge : _edges) {
-                int edge_start = std::get<0>(edge);
-                int edge_end = std::get<1>(edge);
-                int edge_row = (std::get<2>(edge) * 2) + 1;
-                if (edge_row > row) {
-                        if (edge_start == col || edge_end == col)
-                                character = '|';
-                }
-        }
-        return character;
 }
 
-std::tuple<int, int, int> PrintCoordinates::get_active_edge(int row)
+/**
+ * print
+ * Write the part of the drawing within `viewport`, which is clipped to
+ * the drawing. The head is written above the rows of every viewport.
+ */
+void PrintCoordinates::print(OutputSink& sink, const Viewport& viewport)
 {
-        for (auto& edge : _edges) {
-                if (((std::get<2>(edge) * 2) + 1) == row) {
-                        return edge;
-                }
+        int first = std::max(viewport.first_column, 0);
+        int last = std::min(static_cast<long>(columns()),
+                            static_cast<long>(viewport.first_column) +
+                            viewport.columns);
+        int first_row = std::max(viewport.first_row, 0);
+        int last_row = std::min(static_cast<long>(rows()),
+                                static_cast<long>(viewport.first_row) +
+                                viewport.rows);
+        if (first >= last)
+                return;
+        print_head(sink, first, last);
+        for (int row = first_row ; row < last_row ; row++) {
+                print_row(row, sink, first, last);
         }
-        return std::make_tuple(-1, -1, -1);
+}
+
+/**
+ * get_char_for_point
+ * Character of column `col` in `row`, `edge_start` and `edge_end` are the
+ * columns of the edge of the row nearest to the right of `col`, or -1.
+ */
+char PrintCoordinates::get_char_for_point(int row, int col, int edge_start,
+                                          int edge_end)
+{
+        /* a vertical line runs down to the last edge of the column */
+        bool vertical = _vertical_end[col] > row;
+
+        /* Is point within the range of the edge of the row */
+        if (col == edge_start || col == edge_end)
+                return 'O';
+        if (col > edge_start && col < edge_end)
+                return vertical ? '+' : '-';
+        return vertical ? '|' : ' ';
 }
 } /* namespace ascii_graph */
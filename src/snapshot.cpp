@@ -0,0 +1,475 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "snapshot.h"
+
+namespace ascii_graph {
+static const char snapshot_magic[8] = { 'A', 'S', 'G', 'R', 'A', 'P', 'H',
+                                        '\0' };
+static const uint32_t snapshot_version = 4;
+/* flags of the header */
+static const uint64_t directed_flag = 1;
+static const uint64_t weighted_flag = 2;
+/* written as is, reads back differently on a machine of other endianness */
+static const uint32_t byte_order_mark = 0x01020304;
+
+/* Sections of a snapshot, in file order */
+enum Section {
+        NameArena,
+        NameOffsets,
+        NameSlots,
+        CsrOffsets,
+        CsrTargets,
+        /* empty unless the graph is directed */
+        CsrInOffsets,
+        CsrInTargets,
+        /* empty unless the graph is weighted */
+        CsrWeights,
+        CsrInWeights,
+        /* empty without a landmark index, the last one unless directed */
+        Landmarks,
+        LandmarkFrom,
+        LandmarkTo,
+        SectionCount,
+};
+
+struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint64_t vertices;
+        uint64_t flags;
+        uint64_t offset[SectionCount];
+        uint64_t size[SectionCount];
+        uint64_t checksum[SectionCount];
+        /* covers all fields above */
+        uint64_t header_checksum;
+};
+
+/**
+ * checksum
+ * Hash `size` bytes a word at a time, on four independent lanes so that
+ * verifying a snapshot runs at memory speed.
+ */
+static uint64_t checksum(const char* data, std::size_t size)
+{
+        const uint64_t prime = 0x9e3779b97f4a7c15ULL;
+        uint64_t lanes[4] = { 1, 2, 3, 4 };
+        std::size_t index = 0;
+        for ( ; index + sizeof(lanes) <= size ; index += sizeof(lanes)) {
+                for (int lane = 0 ; lane < 4 ; lane++) {
+                        uint64_t word;
+                        std::memcpy(&word, data + index + 8 * lane, 8);
+                        lanes[lane] = (lanes[lane] ^ word) * prime;
+                        lanes[lane] ^= lanes[lane] >> 29;
+                }
+        }
+        uint64_t value = size;
+        for (int lane = 0 ; lane < 4 ; lane++) {
+                value = (value ^ lanes[lane]) * prime;
+                value ^= value >> 32;
+        }
+        for ( ; index < size ; index++) {
+                value = (value ^ static_cast<unsigned char>(data[index])) *
+                        prime;
+        }
+        return value ^ (value >> 32);
+}
+
+static uint64_t header_checksum(const SnapshotHeader& header)
+{
+        return checksum(reinterpret_cast<const char*>(&header),
+                        offsetof(SnapshotHeader, header_checksum));
+}
+
+static uint64_t align(uint64_t offset)
+{
+        return (offset + 7) & ~uint64_t(7);
+}
+
+/**
+ * write
+ * Store the frozen graph made of `names` and `csr` at `path`, `reverse`
+ * holds the arcs entering every vertex of a directed graph and is null for
+ * an undirected one. The `landmarks` of the graph are stored if given.
+ */
+bool Snapshot::write(const std::string& path, const SymbolTable& names,
+                     const CsrGraph& csr, const CsrGraph* reverse,
+                     const LandmarkIndex* landmarks)
+{
+        uint64_t vertices = csr.vertices();
+        if (vertices == 0 || static_cast<int>(vertices) != names.size()) {
+                std::cerr << "ERROR: Only a frozen graph with vertices can be"
+                          << " stored as a snapshot." << std::endl;
+                return false;
+        }
+
+        SnapshotHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+        header.version = snapshot_version;
+        header.byte_order = byte_order_mark;
+        header.vertices = vertices;
+        header.flags = (reverse ? directed_flag : 0) |
+                (csr.weighted() ? weighted_flag : 0);
+        if (landmarks && (landmarks->empty() ||
+                          landmarks->vertices() != csr.vertices() ||
+                          landmarks->directed() != (reverse != nullptr)))
+                landmarks = nullptr;
+        const char* data[SectionCount] = {
+                names.arena(),
+                reinterpret_cast<const char*>(names.offsets()),
+                reinterpret_cast<const char*>(names.slots()),
+                reinterpret_cast<const char*>(csr.offsets()),
+                reinterpret_cast<const char*>(csr.targets()),
+                reverse ? reinterpret_cast<const char*>(reverse->offsets()) :
+                        nullptr,
+                reverse ? reinterpret_cast<const char*>(reverse->targets()) :
+                        nullptr,
+                reinterpret_cast<const char*>(csr.weights()),
+                reverse ? reinterpret_cast<const char*>(reverse->weights()) :
+                        nullptr,
+                landmarks ? reinterpret_cast<const char*>(
+                        landmarks->landmarks()) : nullptr,
+                landmarks ? reinterpret_cast<const char*>(landmarks->from()) :
+                        nullptr,
+                landmarks ? reinterpret_cast<const char*>(landmarks->to()) :
+                        nullptr,
+        };
+        header.size[NameArena] = names.arena_size();
+        header.size[NameOffsets] = (vertices + 1) * sizeof(uint64_t);
+        header.size[NameSlots] = names.slot_count() *
+                sizeof(SymbolTable::Slot);
+        header.size[CsrOffsets] = (vertices + 1) * sizeof(int);
+        header.size[CsrTargets] = csr.arcs() * sizeof(int);
+        if (reverse) {
+                header.size[CsrInOffsets] = header.size[CsrOffsets];
+                header.size[CsrInTargets] = header.size[CsrTargets];
+        }
+        if (csr.weighted()) {
+                header.size[CsrWeights] = csr.arcs() * sizeof(float);
+                if (reverse)
+                        header.size[CsrInWeights] = header.size[CsrWeights];
+        }
+        if (landmarks) {
+                header.size[Landmarks] = landmarks->count() * sizeof(int);
+                header.size[LandmarkFrom] = vertices * landmarks->count() *
+                        sizeof(float);
+                if (reverse)
+                        header.size[LandmarkTo] = header.size[LandmarkFrom];
+        }
+        uint64_t offset = align(sizeof(header));
+        for (int index = 0 ; index < SectionCount ; index++) {
+                header.offset[index] = offset;
+                header.checksum[index] = checksum(data[index],
+                                                  header.size[index]);
+                offset = align(offset + header.size[index]);
+        }
+        header.header_checksum = header_checksum(header);
+
+        std::ofstream file(path, std::ios::out | std::ios::binary |
+                           std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        const char padding[8] = { 0 };
+        uint64_t written = sizeof(header);
+        for (int index = 0 ; index < SectionCount ; index++) {
+                file.write(padding, header.offset[index] - written);
+                file.write(data[index], header.size[index]);
+                written = header.offset[index] + header.size[index];
+        }
+        file.close();
+        if (!file) {
+                std::cerr << "ERROR: Failed to write the snapshot at " << path
+                          << " ." << std::endl;
+                return false;
+        }
+        return true;
+}
+
+const char* Snapshot::section(int index) const
+{
+        return _file.data() + _header->offset[index];
+}
+
+int Snapshot::vertices() const
+{
+        return _header ? static_cast<int>(_header->vertices) : 0;
+}
+
+bool Snapshot::directed() const
+{
+        return _header && (_header->flags & directed_flag);
+}
+
+bool Snapshot::weighted() const
+{
+        return _header && (_header->flags & weighted_flag);
+}
+
+/* Number of landmarks of the stored index, 0 without one */
+int Snapshot::landmark_count() const
+{
+        return _header ? static_cast<int>(_header->size[Landmarks] /
+                                          sizeof(int)) : 0;
+}
+
+/**
+ * check_layout
+ * Validate the header and make sure that every section lies within the
+ * file and has the size its array needs.
+ */
+bool Snapshot::check_layout()
+{
+        if (_file.size() < sizeof(SnapshotHeader) ||
+            std::memcmp(_file.data(), snapshot_magic,
+                        sizeof(snapshot_magic)) != 0) {
+                std::cerr << "ERROR: Not a graph snapshot." << std::endl;
+                return false;
+        }
+        _header = reinterpret_cast<const SnapshotHeader*>(_file.data());
+        if (_header->version != snapshot_version) {
+                std::cerr << "ERROR: Unsupported snapshot version "
+                          << _header->version << "." << std::endl;
+                return false;
+        }
+        if (_header->byte_order != byte_order_mark) {
+                std::cerr << "ERROR: The snapshot was written with a "
+                          << "different byte order." << std::endl;
+                return false;
+        }
+        if (_header->header_checksum != header_checksum(*_header)) {
+                std::cerr << "ERROR: The snapshot header is corrupted."
+                          << std::endl;
+                return false;
+        }
+
+        uint64_t vertices = _header->vertices;
+        uint64_t slots = _header->size[NameSlots] /
+                sizeof(SymbolTable::Slot);
+        bool valid = vertices > 0 && vertices < INT_MAX &&
+                _header->size[NameOffsets] ==
+                        (vertices + 1) * sizeof(uint64_t) &&
+                _header->size[NameSlots] % sizeof(SymbolTable::Slot) == 0 &&
+                slots > vertices && (slots & (slots - 1)) == 0 &&
+                _header->size[CsrOffsets] == (vertices + 1) * sizeof(int) &&
+                _header->size[CsrTargets] % sizeof(int) == 0 &&
+                _header->size[CsrTargets] / sizeof(int) < INT_MAX &&
+                (_header->flags & ~(directed_flag | weighted_flag)) == 0;
+        uint64_t in_size = directed() ? _header->size[CsrOffsets] : 0;
+        uint64_t in_targets = directed() ? _header->size[CsrTargets] : 0;
+        uint64_t weights = weighted() ? _header->size[CsrTargets] : 0;
+        valid = valid && _header->size[CsrInOffsets] == in_size &&
+                _header->size[CsrInTargets] == in_targets &&
+                _header->size[CsrWeights] == weights &&
+                _header->size[CsrInWeights] == (directed() ? weights : 0);
+        /* compared by division, the product could overflow */
+        uint64_t landmarks = _header->size[Landmarks] / sizeof(int);
+        uint64_t row = vertices * sizeof(float);
+        uint64_t distances = _header->size[LandmarkFrom];
+        valid = valid && _header->size[Landmarks] % sizeof(int) == 0 &&
+                landmarks <= vertices && distances % row == 0 &&
+                distances / row == landmarks &&
+                _header->size[LandmarkTo] == (directed() ? distances : 0);
+        for (int index = 0 ; index < SectionCount ; index++) {
+                uint64_t offset = _header->offset[index];
+                valid = valid && offset % 8 == 0 && offset <= _file.size() &&
+                        _header->size[index] <= _file.size() - offset;
+        }
+        if (!valid) {
+                std::cerr << "ERROR: The snapshot layout is invalid."
+                          << std::endl;
+                return false;
+        }
+        return true;
+}
+
+/* Make sure that the CSR arrays in the given sections are well formed and
+ * every row is sorted and free of duplicates, the arc lookups rely on it */
+bool Snapshot::check_csr(int offsets_section, int targets_section) const
+{
+        int vertices = static_cast<int>(_header->vertices);
+        const int* offsets = reinterpret_cast<const int*>(
+                section(offsets_section));
+        const int* targets = reinterpret_cast<const int*>(
+                section(targets_section));
+        bool valid = offsets[0] == 0 &&
+                static_cast<uint64_t>(offsets[vertices]) ==
+                        _header->size[targets_section] / sizeof(int);
+        for (int vertex = 0 ; valid && vertex < vertices ; vertex++) {
+                valid = offsets[vertex] <= offsets[vertex + 1];
+        }
+        for (int vertex = 0 ; valid && vertex < vertices ; vertex++) {
+                for (int arc = offsets[vertex] ;
+                     valid && arc < offsets[vertex + 1] ; arc++) {
+                        valid = targets[arc] >= 0 && targets[arc] < vertices &&
+                                (arc == offsets[vertex] ||
+                                 targets[arc - 1] < targets[arc]);
+                }
+        }
+        return valid;
+}
+
+/* Make sure that the floats in the given section are not negative or NaN */
+bool Snapshot::check_weights(int weights_section) const
+{
+        const float* weights = reinterpret_cast<const float*>(
+                section(weights_section));
+        uint64_t count = _header->size[weights_section] / sizeof(float);
+        for (uint64_t arc = 0 ; arc < count ; arc++) {
+                if (!(weights[arc] >= 0))
+                        return false;
+        }
+        return true;
+}
+
+/* Make sure that every landmark is a vertex */
+bool Snapshot::check_landmarks() const
+{
+        const int* landmarks = reinterpret_cast<const int*>(
+                section(Landmarks));
+        for (int index = 0 ; index < landmark_count() ; index++) {
+                if (landmarks[index] < 0 ||
+                    static_cast<uint64_t>(landmarks[index]) >=
+                    _header->vertices)
+                        return false;
+        }
+        return true;
+}
+
+/**
+ * check_content
+ * Compare the checksums of all sections and make sure that every offset,
+ * target and slot stays within its array, so that a damaged file can't
+ * lead to reads outside of the mapping.
+ */
+bool Snapshot::check_content() const
+{
+        for (int index = 0 ; index < SectionCount ; index++) {
+                if (checksum(section(index), _header->size[index]) !=
+                    _header->checksum[index]) {
+                        std::cerr << "ERROR: Checksum mismatch in section "
+                                  << index << " of the snapshot."
+                                  << std::endl;
+                        return false;
+                }
+        }
+
+        int vertices = static_cast<int>(_header->vertices);
+        const uint64_t* names = reinterpret_cast<const uint64_t*>(
+                section(NameOffsets));
+        const SymbolTable::Slot* slots =
+                reinterpret_cast<const SymbolTable::Slot*>(
+                        section(NameSlots));
+        bool valid = names[0] == 0 &&
+                names[vertices] == _header->size[NameArena] &&
+                check_csr(CsrOffsets, CsrTargets) &&
+                (!directed() || check_csr(CsrInOffsets, CsrInTargets)) &&
+                check_weights(CsrWeights) && check_weights(CsrInWeights) &&
+                check_landmarks() && check_weights(LandmarkFrom) &&
+                check_weights(LandmarkTo);
+        for (int vertex = 0 ; valid && vertex < vertices ; vertex++) {
+                valid = names[vertex] <= names[vertex + 1];
+        }
+        int used = 0;
+        uint64_t slot_count = _header->size[NameSlots] /
+                sizeof(SymbolTable::Slot);
+        for (uint64_t slot = 0 ; valid && slot < slot_count ; slot++) {
+                valid = slots[slot].id >= -1 && slots[slot].id < vertices;
+                used += slots[slot].id >= 0;
+        }
+        if (!valid || used != vertices) {
+                std::cerr << "ERROR: The snapshot content is invalid."
+                          << std::endl;
+                return false;
+        }
+        return true;
+}
+
+/**
+ * open
+ * Map the snapshot at `path` and validate it. Without `verify` only the
+ * header is checked, which makes the load time independent of the graph
+ * size but trusts the content of the file.
+ */
+bool Snapshot::open(const std::string& path, bool verify)
+{
+        close();
+        if (!_file.open(path, false)) {
+                std::cerr << "ERROR: Failed to open the snapshot at " << path
+                          << " ." << std::endl;
+                return false;
+        }
+        if (!check_layout() || (verify && !check_content())) {
+                close();
+                return false;
+        }
+        return true;
+}
+
+void Snapshot::close()
+{
+        _file.close();
+        _header = nullptr;
+}
+
+/**
+ * attach
+ * Let `names`, `csr`, for directed graphs `reverse` and `landmarks` use the
+ * arrays of the mapping, which has to stay open while they do. The
+ * `landmarks` are cleared when the snapshot has no index.
+ */
+void Snapshot::attach(SymbolTable* names, CsrGraph* csr, CsrGraph* reverse,
+                      LandmarkIndex* landmarks) const
+{
+        int count = vertices();
+        names->attach(section(NameArena),
+                      reinterpret_cast<const uint64_t*>(section(NameOffsets)),
+                      count,
+                      reinterpret_cast<const SymbolTable::Slot*>(
+                              section(NameSlots)),
+                      _header->size[NameSlots] / sizeof(SymbolTable::Slot));
+        csr->attach(reinterpret_cast<const int*>(section(CsrOffsets)),
+                    reinterpret_cast<const int*>(section(CsrTargets)),
+                    weighted() ? reinterpret_cast<const float*>(
+                            section(CsrWeights)) : nullptr,
+                    count);
+        if (directed())
+                reverse->attach(
+                        reinterpret_cast<const int*>(section(CsrInOffsets)),
+                        reinterpret_cast<const int*>(section(CsrInTargets)),
+                        weighted() ? reinterpret_cast<const float*>(
+                                section(CsrInWeights)) : nullptr,
+                        count);
+        if (landmark_count() == 0) {
+                landmarks->clear();
+                return;
+        }
+        landmarks->attach(reinterpret_cast<const int*>(section(Landmarks)),
+                          landmark_count(),
+                          reinterpret_cast<const float*>(
+                                  section(LandmarkFrom)),
+                          directed() ? reinterpret_cast<const float*>(
+                                  section(LandmarkTo)) : nullptr,
+                          count);
+}
+} /* namespace ascii_graph */
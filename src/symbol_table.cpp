@@ -0,0 +1,200 @@
+/*
+ * Simple handling of a graph data-structure and ASCII representation printer.
+ * Copyright (C) 2020 Sebastian Fricke
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+#include "symbol_table.h"
+
+namespace ascii_graph {
+/* FNV-1a, followed by a finalizer that spreads the bits of similar names */
+uint64_t SymbolTable::hash(const char* name, std::size_t length)
+{
+        uint64_t value = 14695981039346656037ULL;
+        for (std::size_t index = 0 ; index < length ; index++) {
+                value ^= static_cast<unsigned char>(name[index]);
+                value *= 1099511628211ULL;
+        }
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        return value;
+}
+
+/**
+ * probe
+ * Return the slot holding `name`, or the empty slot where it belongs.
+ */
+std::size_t SymbolTable::probe(const char* name, std::size_t length,
+                               uint64_t name_hash) const
+{
+        std::size_t mask = _slot_count - 1;
+        uint32_t tag = static_cast<uint32_t>(name_hash >> 32);
+        for (std::size_t slot = name_hash & mask ; ;
+             slot = (slot + 1) & mask) {
+                const Slot& entry = _slot_data[slot];
+                if (entry.id < 0)
+                        return slot;
+                if (entry.hash == tag && this->length(entry.id) == length &&
+                    std::memcmp(data(entry.id), name, length) == 0)
+                        return slot;
+        }
+}
+
+void SymbolTable::grow(std::size_t capacity)
+{
+        Slot empty = { 0, -1 };
+        _slots.assign(capacity, empty);
+        view();
+        for (int id = 0 ; id < size() ; id++) {
+                uint64_t name_hash = hash(data(id), length(id));
+                std::size_t slot = probe(data(id), length(id), name_hash);
+                _slots[slot].hash = static_cast<uint32_t>(name_hash >> 32);
+                _slots[slot].id = id;
+        }
+}
+
+/**
+ * intern
+ * Return the id of `name`, a new id is assigned to unknown names.
+ */
+int SymbolTable::intern(const char* name, std::size_t length)
+{
+        if (_attached)
+                own();
+        if (2 * (static_cast<std::size_t>(size()) + 1) > _slots.size())
+                grow(_slots.empty() ? 16 : 2 * _slots.size());
+
+        uint64_t name_hash = hash(name, length);
+        std::size_t slot = probe(name, length, name_hash);
+        if (_slots[slot].id >= 0)
+                return _slots[slot].id;
+
+        int id = size();
+        _arena.insert(_arena.end(), name, name + length);
+        _offsets.push_back(_arena.size());
+        _slots[slot].hash = static_cast<uint32_t>(name_hash >> 32);
+        _slots[slot].id = id;
+        view();
+        return id;
+}
+
+/**
+ * find
+ * Return the id of `name`, or -1 if it wasn't interned.
+ */
+int SymbolTable::find(const char* name, std::size_t length) const
+{
+        if (_slot_count == 0)
+                return -1;
+        return _slot_data[probe(name, length, hash(name, length))].id;
+}
+
+/**
+ * reserve
+ * Make room for `names` names with `characters` characters in total.
+ */
+void SymbolTable::reserve(std::size_t names, std::size_t characters)
+{
+        if (_attached)
+                own();
+        _arena.reserve(characters);
+        _offsets.reserve(names + 1);
+        std::size_t capacity = _slots.empty() ? 16 : _slots.size();
+        while (capacity < 2 * names) {
+                capacity *= 2;
+        }
+        if (capacity > _slots.size())
+                grow(capacity);
+        view();
+}
+
+void SymbolTable::clear()
+{
+        _arena.clear();
+        _offsets.assign(1, 0);
+        _slots.clear();
+        _attached = false;
+        view();
+}
+
+SymbolTable::SymbolTable(const SymbolTable& other)
+        : _arena(other._arena), _offsets(other._offsets),
+          _slots(other._slots)
+{
+        if (other._attached)
+                attach(other._arena_data, other._offset_data, other._count,
+                       other._slot_data, other._slot_count);
+        else
+                view();
+}
+
+SymbolTable& SymbolTable::operator=(const SymbolTable& other)
+{
+        if (this == &other)
+                return *this;
+        _arena = other._arena;
+        _offsets = other._offsets;
+        _slots = other._slots;
+        if (other._attached) {
+                attach(other._arena_data, other._offset_data, other._count,
+                       other._slot_data, other._slot_count);
+        } else {
+                _attached = false;
+                view();
+        }
+        return *this;
+}
+
+/**
+ * attach
+ * Use arrays owned by someone else, e.g. a mapped snapshot, as storage.
+ * They have to outlive the table or the next interning of a new name.
+ */
+void SymbolTable::attach(const char* arena, const uint64_t* offsets,
+                         int count, const Slot* slots,
+                         std::size_t slot_count)
+{
+        _arena.clear();
+        _offsets.clear();
+        _slots.clear();
+        _arena_data = arena;
+        _offset_data = offsets;
+        _slot_data = slots;
+        _slot_count = slot_count;
+        _count = count;
+        _attached = true;
+}
+
+/* point the arrays in use at the own vectors */
+void SymbolTable::view()
+{
+        _arena_data = _arena.data();
+        _offset_data = _offsets.data();
+        _slot_data = _slots.data();
+        _slot_count = _slots.size();
+        _count = static_cast<int>(_offsets.size() - 1);
+}
+
+/* copy attached arrays into the own vectors before they are modified */
+void SymbolTable::own()
+{
+        _arena.assign(_arena_data, _arena_data + _offset_data[_count]);
+        _offsets.assign(_offset_data, _offset_data + _count + 1);
+        _slots.assign(_slot_data, _slot_data + _slot_count);
+        _attached = false;
+        view();
+}
+} /* namespace ascii_graph */
@@ -0,0 +1,95 @@
+#include <cstdint>
+#include <iostream>
+#include "arena.h"
+#include "graph.h"
+#include "test.h"
+
+using namespace ascii_graph;
+
+class ArenaTest : public Test
+{
+protected:
+        int run()
+        {
+                Arena arena(256);
+                char* bytes = static_cast<char*>(arena.allocate(3, 1));
+                void* words = arena.allocate(16, 8);
+                if (reinterpret_cast<uintptr_t>(words) % 8 != 0 ||
+                    static_cast<char*>(words) < bytes + 3) {
+                        std::cout << "Test failed: aligned allocation"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* the latest allocation is given back, a scope rewinds the
+                 * rest and the blocks are reused */
+                arena.deallocate(words, 16);
+                if (arena.allocate(16, 8) != words) {
+                        std::cout << "Test failed: latest allocation wasn't "
+                                  << "reused" << std::endl;
+                        return TestFail;
+                }
+                long blocks = 0;
+                for (int round = 0 ; round < 3 ; round++) {
+                        if (round == 1)
+                                blocks = arena.stats().blocks;
+                        Arena::Scope scope(arena);
+                        ArenaVector<int> numbers(&arena);
+                        for (int number = 0 ; number < 1000 ; number++) {
+                                numbers.push_back(number);
+                        }
+                        if (numbers[999] != 999) {
+                                std::cout << "Test failed: arena vector"
+                                          << std::endl;
+                                return TestFail;
+                        }
+                }
+                if (blocks < 2 || arena.stats().blocks != blocks) {
+                        std::cout << "Test failed: " << arena.stats().blocks
+                                  << " blocks were taken from the heap"
+                                  << std::endl;
+                        return TestFail;
+                }
+                arena.release();
+                if (arena.stats().reserved != 0) {
+                        std::cout << "Test failed: release" << std::endl;
+                        return TestFail;
+                }
+                return run_graph();
+        }
+
+        /* repeated searches on a graph reuse the same blocks */
+        int run_graph()
+        {
+                Graph graph;
+                Arena session;
+                graph.set_arena(&session);
+                for (int index = 0 ; index < 2000 ; index++) {
+                        graph.create_vertex(std::to_string(index));
+                        if (index > 0)
+                                graph.link_two_vertices_undirected(index - 1,
+                                                                   index);
+                }
+                graph.set_cache_capacity(0, 0);
+                graph.get_shortest_path("0", "1999");
+                long blocks = session.stats().blocks;
+                for (int goal = 1000 ; goal < 1010 ; goal++) {
+                        graph.get_shortest_path("0", std::to_string(goal),
+                                                PathAlgorithm::Bfs);
+                        graph.get_shortest_path(
+                                "5", std::to_string(goal),
+                                PathAlgorithm::BidirectionalBfs);
+                }
+                if (blocks == 0 || session.stats().blocks != blocks ||
+                    graph.arena_stats().allocations !=
+                    session.stats().allocations ||
+                    graph.get_shortest_path("0", "3").size() != 4) {
+                        std::cout << "Test failed: searches in an arena"
+                                  << std::endl;
+                        return TestFail;
+                }
+                return TestPass;
+        }
+};
+
+TEST_REGISTER(ArenaTest)
@@ -0,0 +1,271 @@
+#include <iostream>
+#include <queue>
+#include <random>
+#include "bfs.h"
+#include "bit_matrix.h"
+#include "parallel_bfs.h"
+#include "multi_source_bfs.h"
+#include "csr.h"
+#include "test.h"
+
+using namespace ascii_graph;
+
+class BfsTest : public Test
+{
+protected:
+        int init()
+        {
+                /* random sparse graph, a few vertices stay isolated */
+                std::mt19937 random(42);
+                std::uniform_int_distribution<int> pick(0, vertices - 1);
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        builder.add_vertex();
+                }
+                for (int edge = 0 ; edge < 4 * vertices ; edge++) {
+                        int from = pick(random);
+                        int to = pick(random);
+                        if (from % 97 == 0 || to % 97 == 0)
+                                continue;
+                        builder.add_arc(from, to);
+                        builder.add_arc(to, from);
+                }
+                csr.freeze(builder);
+
+                /* random directed graph and its reverse arcs */
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        builder.add_vertex();
+                }
+                for (int arc = 0 ; arc < 3 * vertices ; arc++) {
+                        builder.add_arc(pick(random), pick(random));
+                }
+                directed.freeze(builder);
+                reverse.transpose(directed);
+
+                return TestPass;
+        }
+
+        /* plain queue based search as reference */
+        std::vector<int> reference_distances(const CsrGraph& graph,
+                                             int source)
+        {
+                std::vector<int> distance(vertices, -1);
+                std::queue<int> queue;
+                distance[source] = 0;
+                queue.push(source);
+                while (!queue.empty()) {
+                        int current = queue.front();
+                        queue.pop();
+                        for (const int* adj = graph.begin(current) ;
+                             adj != graph.end(current) ; ++adj) {
+                                if (distance[*adj] >= 0)
+                                        continue;
+                                distance[*adj] = distance[current] + 1;
+                                queue.push(*adj);
+                        }
+                }
+                return distance;
+        }
+
+        int run()
+        {
+                BfsEngine<CsrGraph> engine(csr, csr);
+                std::vector<int> distance = reference_distances(csr, 1);
+                engine.run(1);
+                if (engine.bottom_up_steps() == 0 ||
+                    engine.top_down_steps() == 0) {
+                        std::cout << "Test failed: expected both search "
+                                  << "directions to be used" << std::endl;
+                        return TestFail;
+                }
+
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        std::vector<int> path = engine.path(vertex);
+                        if (static_cast<int>(path.size()) - 1 !=
+                            distance[vertex]) {
+                                std::cout << "Test failed: path to "
+                                          << vertex << " has " << path.size()
+                                          << " vertices, distance is "
+                                          << distance[vertex] << std::endl;
+                                return TestFail;
+                        }
+                        for (std::size_t i = 1 ; i < path.size() ; i++) {
+                                if (!csr.has_arc(path[i - 1], path[i])) {
+                                        std::cout << "Test failed: path to "
+                                                  << vertex << " uses a "
+                                                  << "missing arc" << std::endl;
+                                        return TestFail;
+                                }
+                        }
+                }
+
+                /* early exit for point to point queries */
+                engine.run(1, 2);
+                if (static_cast<int>(engine.path(2).size()) - 1 !=
+                    distance[2]) {
+                        std::cout << "Test failed: path from 1 to 2"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                BidirectionalBfs<CsrGraph> bidirectional(csr, csr);
+                for (int goal = 0 ; goal < vertices ; goal += 7) {
+                        std::vector<int> path = bidirectional.run(1, goal);
+                        if (static_cast<int>(path.size()) - 1 !=
+                            distance[goal] ||
+                            (!path.empty() && (path.front() != 1 ||
+                                               path.back() != goal))) {
+                                std::cout << "Test failed: bidirectional "
+                                          << "path from 1 to " << goal
+                                          << std::endl;
+                                return TestFail;
+                        }
+                        for (std::size_t i = 1 ; i < path.size() ; i++) {
+                                if (!csr.has_arc(path[i - 1], path[i])) {
+                                        std::cout << "Test failed: "
+                                                  << "bidirectional path to "
+                                                  << goal << " uses a missing"
+                                                  << " arc" << std::endl;
+                                        return TestFail;
+                                }
+                        }
+                }
+
+                ParallelBfs<CsrGraph> parallel(csr, 4);
+                parallel.run(1);
+                if (parallel.levels() != distance) {
+                        std::cout << "Test failed: parallel search levels "
+                                  << "differ from the reference" << std::endl;
+                        return TestFail;
+                }
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        if (!parallel.visited(vertex) || vertex == 1 ?
+                            parallel.parent(vertex) != -1 :
+                            distance[parallel.parent(vertex)] !=
+                            distance[vertex] - 1) {
+                                std::cout << "Test failed: parallel search "
+                                          << "parent of " << vertex
+                                          << std::endl;
+                                return TestFail;
+                        }
+                }
+                /* the arrays are reset for the next search */
+                parallel.run(0, 2);
+                parallel.run(2);
+                if (parallel.levels() != reference_distances(csr, 2)) {
+                        std::cout << "Test failed: repeated parallel search "
+                                  << "levels differ from the reference"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* lane 3 searches from vertex 1 as well */
+                std::vector<int> sources;
+                for (int lane = 0 ; lane < MultiSourceBfs<CsrGraph>::lanes ;
+                     lane++) {
+                        sources.push_back((lane * 31) % vertices);
+                }
+                sources[3] = 1;
+                MultiSourceBfs<CsrGraph> multi_source(csr, csr);
+                multi_source.run(sources);
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        if (multi_source.distance(3, vertex) !=
+                            distance[vertex]) {
+                                std::cout << "Test failed: multi source "
+                                          << "distance to " << vertex
+                                          << std::endl;
+                                return TestFail;
+                        }
+                }
+                if (multi_source.path(3, 2).size() != engine.path(2).size()) {
+                        std::cout << "Test failed: multi source path to 2"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                return run_directed();
+        }
+
+        /* the searches have to follow the direction of the arcs */
+        int run_directed()
+        {
+                bool reversed = reverse.arcs() == directed.arcs();
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        directed.for_each(vertex, [&](int adj) {
+                                reversed = reversed &&
+                                        reverse.has_arc(adj, vertex);
+                        });
+                }
+                if (!reversed) {
+                        std::cout << "Test failed: transposed graph"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                std::vector<int> distance = reference_distances(directed, 1);
+                BfsEngine<CsrGraph> engine(directed, reverse);
+                BidirectionalBfs<CsrGraph> bidirectional(directed, reverse);
+                MultiSourceBfs<CsrGraph> multi_source(directed, reverse);
+                engine.run(1);
+                multi_source.run(std::vector<int>(1, 1));
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        std::vector<int> path = engine.path(vertex);
+                        if (static_cast<int>(path.size()) - 1 !=
+                            distance[vertex] ||
+                            multi_source.distance(0, vertex) !=
+                            distance[vertex]) {
+                                std::cout << "Test failed: directed distance"
+                                          << " to " << vertex << std::endl;
+                                return TestFail;
+                        }
+                        if (vertex % 7 != 0)
+                                continue;
+                        path = bidirectional.run(1, vertex);
+                        if (static_cast<int>(path.size()) - 1 !=
+                            distance[vertex]) {
+                                std::cout << "Test failed: directed "
+                                          << "bidirectional path to "
+                                          << vertex << std::endl;
+                                return TestFail;
+                        }
+                        for (std::size_t i = 1 ; i < path.size() ; i++) {
+                                if (!directed.has_arc(path[i - 1], path[i])) {
+                                        std::cout << "Test failed: directed "
+                                                  << "path to " << vertex
+                                                  << " uses a missing arc"
+                                                  << std::endl;
+                                        return TestFail;
+                                }
+                        }
+                }
+
+                /* the bit matrix counts every distinct arc once */
+                BitMatrix dense;
+                BitMatrix dense_in;
+                dense.assign(directed);
+                dense_in.assign(reverse);
+                BfsEngine<BitMatrix> dense_engine(dense, dense_in);
+                dense_engine.run(1);
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        int count = 0;
+                        dense.for_each(vertex, [&](int) { count++; });
+                        std::vector<int> path = dense_engine.path(vertex);
+                        if (dense.degree(vertex) != count ||
+                            static_cast<int>(path.size()) - 1 !=
+                            distance[vertex]) {
+                                std::cout << "Test failed: bit matrix degree"
+                                          << " or distance of " << vertex
+                                          << std::endl;
+                                return TestFail;
+                        }
+                }
+                return TestPass;
+        }
+private:
+        static const int vertices = 5000;
+        CsrBuilder builder;
+        CsrGraph csr;
+        CsrGraph directed;
+        CsrGraph reverse;
+};
+
+TEST_REGISTER(BfsTest)
@@ -0,0 +1,167 @@
+#include <unistd.h>
+#include <stdlib.h>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "concurrent_graph.h"
+#include "epoch.h"
+#include "test.h"
+
+using namespace ascii_graph;
+
+class ConcurrentTest : public Test
+{
+protected:
+        /* a reader pins what was retired after it entered */
+        int run_epochs()
+        {
+                EpochDomain domain;
+                bool freed = false;
+                {
+                        EpochDomain::Guard guard(domain);
+                        domain.retire([&]() { freed = true; });
+                        domain.collect();
+                        if (freed || domain.pending() != 1) {
+                                std::cout << "Test failed: freed while "
+                                          << "pinned" << std::endl;
+                                return TestFail;
+                        }
+                }
+                EpochDomain::Guard late(domain);
+                domain.collect();
+                if (!freed || domain.pending() != 0) {
+                        std::cout << "Test failed: not freed after the "
+                                  << "reader left" << std::endl;
+                        return TestFail;
+                }
+                return TestPass;
+        }
+
+        /* every version a reader sees is a complete chain v0 .. vN-1
+         * published by update N */
+        bool check(const ConcurrentGraph::Reader& reader)
+        {
+                int count = reader.vertices();
+                if (reader.version() != static_cast<unsigned long>(count))
+                        return false;
+                if (count < 2)
+                        return true;
+                std::string last = "v" + std::to_string(count - 1);
+                std::size_t length = static_cast<std::size_t>(count);
+                return reader.get_shortest_path("v0", last).size() ==
+                        length &&
+                        reader.get_shortest_path(
+                                last, "v0",
+                                PathAlgorithm::BidirectionalBfs).size() ==
+                        length &&
+                        reader.get_shortest_distance("v0", last) ==
+                        count - 1;
+        }
+
+        int run()
+        {
+                if (run_epochs() != TestPass)
+                        return TestFail;
+
+                ConcurrentGraph graph;
+                std::atomic<bool> done(false);
+                std::atomic<int> failures(0);
+                std::atomic<long> queries(0);
+                auto read = [&]() {
+                        unsigned long seen = 0;
+                        while (!done.load()) {
+                                ConcurrentGraph::Reader reader(graph);
+                                if (reader.version() < seen ||
+                                    !check(reader))
+                                        failures++;
+                                seen = reader.version();
+                                queries++;
+                        }
+                };
+                std::vector<std::thread> readers;
+                for (int index = 0 ; index < 6 ; index++) {
+                        readers.push_back(std::thread(read));
+                }
+                for (int index = 0 ; index < 300 ; index++) {
+                        graph.update([&](Graph& writable) {
+                                int vertex = writable.create_vertex(
+                                        "v" + std::to_string(index));
+                                if (vertex > 0)
+                                        writable.link_two_vertices_undirected(
+                                                vertex - 1, vertex);
+                        });
+                }
+                while (queries.load() < 1000) {
+                        std::this_thread::yield();
+                }
+                done = true;
+                for (auto& thread : readers) {
+                        thread.join();
+                }
+                if (failures.load() || graph.version() != 300 ||
+                    graph.get_shortest_path("v299", "v0").size() != 300) {
+                        std::cout << "Test failed: " << failures.load()
+                                  << " inconsistent versions in "
+                                  << queries.load() << " queries"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* without readers the next update frees all old versions */
+                graph.update([](Graph&) {});
+                if (graph.retired() != 0) {
+                        std::cout << "Test failed: " << graph.retired()
+                                  << " versions kept" << std::endl;
+                        return TestFail;
+                }
+
+                /* a removed vertex can't be found in the next version */
+                graph.update([](Graph& writable) {
+                        writable.remove_vertex(writable.vertex_index("v5"));
+                });
+                ConcurrentGraph::Reader reader(graph);
+                if (reader.vertex_index("v5") != -1 ||
+                    !reader.get_shortest_path("v0", "v299").empty() ||
+                    reader.get_shortest_path("v6", "v299").size() != 294) {
+                        std::cout << "Test failed: removal" << std::endl;
+                        return TestFail;
+                }
+                return run_snapshot();
+        }
+
+        /* a graph loaded into the writer keeps its mapping alive */
+        int run_snapshot()
+        {
+                std::string path = "/tmp/ascii_graph.concurrent.XXXXXX";
+                int fd = mkstemp(&path.front());
+                if (fd < 0)
+                        return TestFail;
+                close(fd);
+                Graph source;
+                source.create_vertex("from");
+                source.create_vertex("to");
+                source.link_two_vertices_directed(0, 1, 2.5);
+                bool saved = source.save_snapshot(path);
+
+                ConcurrentGraph graph;
+                bool loaded = false;
+                graph.update([&](Graph& writable) {
+                        loaded = writable.load_snapshot(path);
+                });
+                unlink(path.c_str());
+                ConcurrentGraph::Reader reader(graph);
+                if (!saved || !loaded || !reader.directed() ||
+                    reader.vertex_name(1) != "to" ||
+                    reader.get_shortest_distance("from", "to") != 2.5 ||
+                    !reader.get_shortest_path("to", "from").empty()) {
+                        std::cout << "Test failed: loaded graph"
+                                  << std::endl;
+                        return TestFail;
+                }
+                return TestPass;
+        }
+};
+
+TEST_REGISTER(ConcurrentTest)
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <limits>
 #include <tuple>
 #include "graph.h"
 #include "test.h"
@@ -79,6 +80,501 @@ protected:
                         return TestFail;
                 }
 
+                /* extend the graph after it was frozen by the queries */
+                graph.create_vertex('G');
+                graph.link_two_vertices_undirected(5, 6);
+                graph.link_two_vertices_undirected(6, 5);
+                std::vector<char> result_a_g {'A', 'C', 'F', 'G'};
+                if ((result = graph.get_shortest_path('A', 'G'))
+                    != result_a_g) {
+                        error_message("shortest Path from 'A' to 'G'",
+                                      result_a_g, result);
+                        return TestFail;
+                }
+
+                graph.set_threads(3);
+                if ((result = graph.get_shortest_path(
+                        'A', 'F', PathAlgorithm::ParallelBfs)).size() != 3) {
+                        error_message("parallel: shortest Path from 'A' to"
+                                      " 'F'", result_a_f, result);
+                        return TestFail;
+                }
+                if (graph.bfs_levels('A') !=
+                    std::vector<int>({0, 1, 1, 2, 3, 2, 3})) {
+                        std::cout << "Test failed: levels from 'A'"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                if ((result = graph.get_shortest_path(
+                        'E', 'F', PathAlgorithm::BidirectionalBfs)) !=
+                    result_e_f) {
+                        error_message("bidirectional: shortest Path from 'E'"
+                                      " to 'F'", result_e_f, result);
+                        return TestFail;
+                }
+
+                std::vector< std::vector<char> > batch =
+                        graph.get_shortest_paths({{'A', 'E'}, {'E', 'F'},
+                                                  {'A', 'F'}, {'A', 'Z'}});
+                if (batch.size() != 4 || batch[0].size() != 4 ||
+                    batch[1] != result_e_f || batch[2] != result_a_f ||
+                    !batch[3].empty()) {
+                        std::cout << "Test failed: batch of shortest paths"
+                                  << std::endl;
+                        return TestFail;
+                }
+                if (graph.distance_matrix(std::vector<char>({'A'})) !=
+                    std::vector< std::vector<int> >({{0, 1, 1, 2, 3, 2,
+                                                      3}})) {
+                        std::cout << "Test failed: distance matrix"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* vertices with longer names */
+                int gateway = graph.create_vertex("gateway");
+                int billing = graph.create_vertex("billing-service");
+                if (graph.create_vertex("gateway") != gateway ||
+                    graph.vertex_name(billing) != "billing-service") {
+                        std::cout << "Test failed: named vertices"
+                                  << std::endl;
+                        return TestFail;
+                }
+                graph.link_two_vertices_undirected(0, gateway);
+                graph.link_two_vertices_undirected(gateway, billing);
+                std::vector<std::string> named_path {"E", "D", "B", "A",
+                                                     "gateway",
+                                                     "billing-service"};
+                if (graph.get_shortest_path("E", "billing-service") !=
+                    named_path) {
+                        std::cout << "Test failed: shortest Path from 'E' to"
+                                  << " 'billing-service'" << std::endl;
+                        return TestFail;
+                }
+
+                graph.set_storage(StorageMode::BitMatrix);
+                if ((result = graph.get_shortest_path('E', 'G'))
+                    != std::vector<char>({'E', 'D', 'C', 'F', 'G'})) {
+                        error_message("bit matrix: shortest Path from 'E' to"
+                                      " 'G'", {'E', 'D', 'C', 'F', 'G'},
+                                      result);
+                        return TestFail;
+                }
+
+                return run_directed();
+        }
+
+        /* a one way ring a -> b -> c -> a with a dead end d */
+        int run_directed()
+        {
+                Graph ring;
+                for (auto& name : {"a", "b", "c", "d"}) {
+                        ring.create_vertex(name);
+                }
+                ring.link_two_vertices_directed(0, 1);
+                ring.link_two_vertices_directed(1, 2);
+                ring.link_two_vertices_directed(2, 0);
+                ring.link_two_vertices_directed(0, 3);
+                std::vector<std::string> c_to_b {"c", "a", "b"};
+                PathAlgorithm algorithms[] = {
+                        PathAlgorithm::Bfs,
+                        PathAlgorithm::ParallelBfs,
+                        PathAlgorithm::BidirectionalBfs,
+                };
+                for (auto& storage : {StorageMode::Csr,
+                                      StorageMode::BitMatrix}) {
+                        ring.set_storage(storage);
+                        for (auto& algorithm : algorithms) {
+                                if (ring.get_shortest_path("c", "b",
+                                                           algorithm) !=
+                                    c_to_b ||
+                                    !ring.get_shortest_path("d", "a",
+                                                            algorithm)
+                                            .empty()) {
+                                        std::cout << "Test failed: directed "
+                                                  << "shortest paths"
+                                                  << std::endl;
+                                        return TestFail;
+                                }
+                        }
+                        if (ring.distance_matrix(std::vector<std::string>(
+                                    {"b"})) !=
+                            std::vector< std::vector<int> >(
+                                    {{2, 0, 1, 3}}) ||
+                            ring.get_shortest_paths(
+                                    std::vector< std::pair<std::string,
+                                                           std::string> >(
+                                            {{"c", "b"}}))[0] != c_to_b) {
+                                std::cout << "Test failed: directed batch "
+                                          << "searches" << std::endl;
+                                return TestFail;
+                        }
+                }
+                if (!ring.directed() || graph.directed()) {
+                        std::cout << "Test failed: directed flag"
+                                  << std::endl;
+                        return TestFail;
+                }
+                return run_weighted();
+        }
+
+        /* the direct road s - t is longer than the detour over a and b */
+        int run_weighted()
+        {
+                Graph roads;
+                for (auto& name : {"s", "a", "b", "t"}) {
+                        roads.create_vertex(name);
+                }
+                roads.link_two_vertices_undirected(0, 3, 10);
+                roads.link_two_vertices_undirected(0, 1, 1);
+                roads.link_two_vertices_undirected(1, 2, 1.5);
+                roads.link_two_vertices_undirected(2, 3, 2);
+                if (roads.link_two_vertices_undirected(0, 2, -1) != -1 ||
+                    roads.link_two_vertices_directed(
+                            0, 2, std::numeric_limits<float>::quiet_NaN()) !=
+                    -1 || !roads.weighted() || roads.directed()) {
+                        std::cout << "Test failed: weighted links"
+                                  << std::endl;
+                        return TestFail;
+                }
+                std::vector<std::string> detour {"s", "a", "b", "t"};
+                std::vector<std::string> direct {"s", "t"};
+                for (auto& storage : {StorageMode::Csr,
+                                      StorageMode::BitMatrix}) {
+                        roads.set_storage(storage);
+                        for (auto& algorithm : {PathAlgorithm::Dijkstra,
+                                                PathAlgorithm::DeltaStepping}) {
+                                if (roads.get_shortest_path("s", "t",
+                                                            algorithm) !=
+                                    detour ||
+                                    roads.get_shortest_distance(
+                                            "t", "s", algorithm) != 4.5) {
+                                        std::cout << "Test failed: weighted "
+                                                  << "shortest path"
+                                                  << std::endl;
+                                        return TestFail;
+                                }
+                        }
+                        if (roads.get_shortest_path("s", "t") != direct ||
+                            roads.get_shortest_distance(
+                                    "s", "t", PathAlgorithm::Bfs) != 10) {
+                                std::cout << "Test failed: hop count search "
+                                          << "on a weighted graph"
+                                          << std::endl;
+                                return TestFail;
+                        }
+                }
+
+                roads.set_storage(StorageMode::Csr);
+                if (!roads.build_landmarks(2) || !roads.has_landmarks() ||
+                    roads.get_shortest_path("s", "t",
+                                            PathAlgorithm::Landmarks) !=
+                    detour ||
+                    roads.get_shortest_distance(
+                            "b", "s", PathAlgorithm::Landmarks) != 2.5) {
+                        std::cout << "Test failed: landmark search"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* one way streets and unweighted graphs */
+                roads.link_two_vertices_directed(3, 0, 0.5);
+                if (roads.get_shortest_distance("t", "s") != 0.5 ||
+                    roads.get_shortest_distance("s", "t") != 4.5 ||
+                    roads.has_landmarks() ||
+                    roads.get_shortest_distance(
+                            "t", "s", PathAlgorithm::Landmarks) != 0.5 ||
+                    graph.get_shortest_distance("E", "G") != 4 ||
+                    graph.get_shortest_distance("E", "Z") !=
+                    std::numeric_limits<double>::infinity()) {
+                        std::cout << "Test failed: shortest distances"
+                                  << std::endl;
+                        return TestFail;
+                }
+                return run_cache();
+        }
+
+        /* repeated queries are answered from the cache until the graph
+         * changes */
+        int run_cache()
+        {
+                Graph chain;
+                for (auto& name : {"a", "b", "c", "d", "e"}) {
+                        chain.create_vertex(name);
+                }
+                for (int index = 0 ; index < 4 ; index++) {
+                        chain.link_two_vertices_undirected(index, index + 1);
+                }
+                chain.set_cache_capacity(2, 1);
+                std::vector<std::string> a_to_e {"a", "b", "c", "d", "e"};
+                chain.get_shortest_path("a", "e");
+                if (chain.get_shortest_path("a", "e") != a_to_e ||
+                    chain.cache_stats().path_hits != 1 ||
+                    chain.cache_stats().path_misses != 1) {
+                        std::cout << "Test failed: path cache hit"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* the second miss of a source stores its BFS tree, which
+                 * answers the third goal */
+                chain.get_shortest_path("a", "c");
+                chain.get_shortest_path("a", "b");
+                std::vector<std::string> a_to_d {"a", "b", "c", "d"};
+                if (chain.get_shortest_path("a", "d") != a_to_d ||
+                    chain.cache_stats().tree_hits != 2 ||
+                    chain.cache_stats().tree_misses != 2) {
+                        std::cout << "Test failed: BFS tree cache"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* the least recently used path was evicted */
+                long misses = chain.cache_stats().path_misses;
+                chain.get_shortest_path("a", "e");
+                if (chain.cache_stats().path_misses != misses + 1) {
+                        std::cout << "Test failed: path cache eviction"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                unsigned long version = chain.version();
+                chain.link_two_vertices_undirected(0, 4);
+                std::vector<std::string> shortcut {"a", "e"};
+                if (chain.version() == version ||
+                    chain.get_shortest_path("a", "e") != shortcut ||
+                    chain.get_shortest_path("a", "d") !=
+                    std::vector<std::string>({"a", "e", "d"})) {
+                        std::cout << "Test failed: cache invalidation"
+                                  << std::endl;
+                        return TestFail;
+                }
+                return run_bulk();
+        }
+
+        /* edges added in bulk are merged with the linked ones when the
+         * graph is frozen */
+        int run_bulk()
+        {
+                for (auto mode : {StorageMode::Csr, StorageMode::BitMatrix}) {
+                        Graph bulk;
+                        bulk.set_storage(mode);
+                        bulk.reserve(4, 5);
+                        std::vector<int> ids = bulk.add_vertices(
+                                {"w", "x", "y", "w", "z"});
+                        std::vector<Arc> edges {
+                                {0, 1, 4}, {1, 2, 1}, {0, 1, 2}, {0, 1, 3},
+                        };
+                        std::vector<Arc> invalid {{0, 2, 1}, {2, 7, 1}};
+                        if (ids != std::vector<int>({0, 1, 2, 0, 3}) ||
+                            bulk.add_edges(edges) != 0 ||
+                            bulk.add_edges(invalid) != -1 ||
+                            bulk.link_two_vertices_undirected(2, 3, 1) != 0) {
+                                std::cout << "Test failed: bulk loading"
+                                          << std::endl;
+                                return TestFail;
+                        }
+                        /* of the parallel edges the lightest one stays, the
+                         * rejected batch added nothing */
+                        if (bulk.get_shortest_distance("w", "z") != 4 ||
+                            bulk.get_shortest_distance("z", "x") != 2 ||
+                            bulk.get_shortest_path("w", "y") !=
+                            std::vector<std::string>({"w", "x", "y"})) {
+                                std::cout << "Test failed: bulk edges"
+                                          << std::endl;
+                                return TestFail;
+                        }
+                        std::vector<int> adjacent;
+                        for (int vertex : bulk.neighbors(1)) {
+                                adjacent.push_back(vertex);
+                        }
+                        if (adjacent != std::vector<int>({0, 2}) ||
+                            bulk.neighbors(0).empty()) {
+                                std::cout << "Test failed: neighbors"
+                                          << std::endl;
+                                return TestFail;
+                        }
+                        std::vector<Arc> one_way {{3, 0, 1}};
+                        if (bulk.add_edges(one_way, true) != 0 ||
+                            !bulk.directed() ||
+                            bulk.get_shortest_distance("z", "w") != 1 ||
+                            bulk.get_shortest_distance("w", "z") != 4) {
+                                std::cout << "Test failed: directed bulk "
+                                          << "edges" << std::endl;
+                                return TestFail;
+                        }
+                        /* the view reads the reverse arcs of the directed
+                         * graph */
+                        GraphView view = bulk.view();
+                        adjacent.assign(view.in_neighbors(0).begin(),
+                                        view.in_neighbors(0).end());
+                        if (adjacent != std::vector<int>({1, 3}) ||
+                            !view.linked(0, 3) || view.has_arc(0, 3) ||
+                            view.vertices() != 4) {
+                                std::cout << "Test failed: graph view"
+                                          << std::endl;
+                                return TestFail;
+                        }
+                }
+                return run_formats();
+        }
+
+        /* the sparse matrix formats list the arcs, weights and quoted
+         * names included */
+        int run_formats()
+        {
+                Graph roads;
+                for (auto& name : {"a", "b c", "d"}) {
+                        roads.create_vertex(name);
+                }
+                roads.link_two_vertices_undirected(0, 1, 2.5);
+                roads.link_two_vertices_undirected(1, 2);
+                roads.link_two_vertices_undirected(0, 0);
+                std::string edges;
+                std::string market;
+                std::string runs;
+                {
+                        StringSink edge_sink(edges);
+                        StringSink market_sink(market);
+                        StringSink run_sink(runs);
+                        roads.print_matrix(edge_sink, MatrixFormat::EdgeList);
+                        roads.print_matrix(market_sink,
+                                           MatrixFormat::MatrixMarket);
+                        roads.print_matrix(run_sink, MatrixFormat::RunLength);
+                }
+                if (edges != "a a 1\na \"b c\" 2.5\n\"b c\" d 1\n" ||
+                    market != "%%MatrixMarket matrix coordinate real "
+                    "symmetric\n3 3 3\n1 1 1\n2 1 2.5\n3 2 1\n" ||
+                    runs != "# 3 columns, runs of 0 and 1 per row\n"
+                    "a   | 0 2\nb c | 0 1 1 1\nd   | 1 1\n") {
+                        std::cout << "Test failed: matrix formats" << std::endl
+                                  << edges << market << runs;
+                        return TestFail;
+                }
+                return run_removal();
+        }
+
+        std::string edge_list(Graph& listed)
+        {
+                std::string edges;
+                StringSink sink(edges);
+                listed.print_matrix(sink, MatrixFormat::EdgeList);
+                sink.flush();
+                return edges;
+        }
+
+        /* removed vertices are tombstones until compacted */
+        int run_removal()
+        {
+                Graph ring;
+                for (auto& name : {"a", "b", "c", "d", "e"}) {
+                        ring.create_vertex(name);
+                }
+                for (int index = 0 ; index < 5 ; index++) {
+                        ring.link_two_vertices_undirected(
+                                index, (index + 1) % 5,
+                                index == 3 ? 2.5 : 1);
+                }
+                std::vector<std::string> around = {"a", "b", "c", "d"};
+                if (ring.get_shortest_path("a", "d").size() != 3 ||
+                    ring.remove_edge(0, 4) != 0 ||
+                    ring.remove_edge(4, 0) != -1 ||
+                    ring.get_shortest_path("a", "d") != around ||
+                    ring.remove_vertex(2) != 0 ||
+                    ring.remove_vertex(2) != -1 ||
+                    !ring.get_shortest_path("a", "d").empty() ||
+                    ring.vertex_index("c") != -1 || !ring.removed(2) ||
+                    ring.vertices() != 5 ||
+                    ring.link_two_vertices_undirected(1, 2) != -1 ||
+                    edge_list(ring) != "a b 1\nd e 2.5\n") {
+                        std::cout << "Test failed: removal" << std::endl
+                                  << edge_list(ring);
+                        return TestFail;
+                }
+                std::vector<int> mapping = ring.compact();
+                if (mapping != std::vector<int>({0, 1, -1, 2, 3}) ||
+                    ring.vertices() != 4 || ring.vertex_index("d") != 2 ||
+                    ring.get_shortest_distance("d", "e") != 2.5 ||
+                    ring.create_vertex("c") != 4) {
+                        std::cout << "Test failed: compaction" << std::endl;
+                        return TestFail;
+                }
+
+                /* the arcs into a vertex of a directed graph are swept */
+                Graph cycle;
+                for (auto& name : {"x", "y", "z"}) {
+                        cycle.create_vertex(name);
+                }
+                cycle.add_edges({{0, 1, 1}, {1, 2, 1}, {2, 0, 1}}, true);
+                if (cycle.remove_vertex(1) != 0 ||
+                    edge_list(cycle) != "z x\n" ||
+                    cycle.create_vertex("y") != 1 ||
+                    cycle.remove_edge(2, 0, true) != 0 ||
+                    !edge_list(cycle).empty()) {
+                        std::cout << "Test failed: directed removal"
+                                  << std::endl << edge_list(cycle);
+                        return TestFail;
+                }
+                return run_batch();
+        }
+
+        /* a mutation log addresses the vertices by name */
+        int run_batch()
+        {
+                typedef Mutation::Kind Kind;
+                Graph log;
+                std::vector<Mutation> batch;
+                for (int index = 0 ; index < 9 ; index++) {
+                        Mutation link = { Kind::AddEdge,
+                                          "n" + std::to_string(index),
+                                          "n" + std::to_string(index + 1),
+                                          1, false };
+                        batch.push_back(link);
+                }
+                if (log.apply(batch) != 9 || log.vertices() != 10 ||
+                    log.get_shortest_path("n0", "n9").size() != 10) {
+                        std::cout << "Test failed: batch of links"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* 3 of 10 vertices stay removed, beyond the compaction ratio,
+                 * a revived vertex keeps its index */
+                batch.clear();
+                for (int index = 3 ; index < 7 ; index++) {
+                        Mutation remove = { Kind::RemoveVertex,
+                                            "n" + std::to_string(index), "",
+                                            1, false };
+                        batch.push_back(remove);
+                }
+                Mutation missing = { Kind::RemoveEdge, "n0", "n9", 1, false };
+                Mutation bridge = { Kind::AddEdge, "n2", "n7", 1, false };
+                Mutation vertex = { Kind::AddVertex, "n3", "", 1, false };
+                batch.push_back(missing);
+                batch.push_back(bridge);
+                batch.push_back(vertex);
+                if (log.apply(batch) != 6 || log.removed_vertices() != 0 ||
+                    log.vertices() != 7 || log.vertex_index("n7") != 4 ||
+                    log.vertex_index("n3") != 3 ||
+                    log.get_shortest_path("n0", "n9").size() != 6 ||
+                    !log.get_shortest_path("n0", "n3").empty()) {
+                        std::cout << "Test failed: batch of removals"
+                                  << std::endl << edge_list(log);
+                        return TestFail;
+                }
+
+                /* bulk arcs are frozen before they are removed */
+                Graph bulk;
+                bulk.add_vertices({"p", "q", "r"});
+                bulk.add_edges({{0, 1, 1}, {1, 2, 1}});
+                if (bulk.remove_edge(0, 1) != 0 ||
+                    !bulk.get_shortest_path("p", "r").empty() ||
+                    bulk.get_shortest_path("q", "r").size() != 2) {
+                        std::cout << "Test failed: removal of bulk arcs"
+                                  << std::endl;
+                        return TestFail;
+                }
                 return TestPass;
         }
 private:
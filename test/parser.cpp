@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <tuple>
 #include "parser.h"
 #include "test.h"
@@ -70,6 +71,243 @@ protected:
                                   << std::endl;
                         return TestFail;
                 }
+
+                reset_objects();
+
+                std::string rich_example =
+                        "/* services */\n"
+                        "strict graph \"services\" {\n"
+                        "        graph [rankdir=LR];\n"
+                        "        node [shape=box, color=\"red\"];\n"
+                        "        gateway [label=\"Gate \\\"way\\\"\"]\n"
+                        "        gateway -- \"auth-service\" -- db:p1:n;\n"
+                        "        gateway -- {cache; search} [len=2.5]\n"
+                        "# preprocessor output\n"
+                        "        subgraph cluster_x { x1 -- x2 }\n"
+                        "        rate = -.5\n"
+                        "}\n";
+                if (!parser.parse_content(rich_example, &graph)) {
+                        std::cout << "Test failed: Parse of the rich example"
+                                  << " was not successful." << std::endl;
+                        return TestFail;
+                }
+                std::vector<std::string> expected {"auth-service", "gateway",
+                                                   "search"};
+                if (graph.vertices() != 7 ||
+                    graph.get_shortest_path("auth-service", "search") !=
+                    expected) {
+                        std::cout << "Test failed: Unexpected graph from the"
+                                  << " rich example." << std::endl;
+                        return TestFail;
+                }
+
+                Graph digraph;
+                std::vector<std::string> z_to_y {"z", "x", "y"};
+                if (!parser.parse_content("digraph { x -> y -> z; z -> x }",
+                                          &digraph) ||
+                    !digraph.directed() ||
+                    digraph.get_shortest_path("z", "y") != z_to_y) {
+                        std::cout << "Test failed: Unexpected graph from the"
+                                  << " digraph example." << std::endl;
+                        return TestFail;
+                }
+                if (parser.parse_content("digraph { x -- y }", &digraph)) {
+                        std::cout << "Test failed: '--' in a digraph should"
+                                  << " not be accepted." << std::endl;
+                        return TestFail;
+                }
+
+                Graph weighted;
+                if (!parser.parse_content(
+                            "graph w {\n"
+                            "        edge [weight=3]\n"
+                            "        a -- b; b -- c [weight=0.5]\n"
+                            "        subgraph s { edge [len=10]; c -- d }\n"
+                            "        c -- e; a -- d [weight=1, weight=2]\n"
+                            "}\n", &weighted) ||
+                    weighted.get_shortest_distance("a", "c") != 3.5 ||
+                    weighted.get_shortest_distance("a", "e") != 6.5 ||
+                    weighted.get_shortest_distance("b", "d") != 5) {
+                        std::cout << "Test failed: Unexpected graph from the"
+                                  << " weighted example." << std::endl;
+                        return TestFail;
+                }
+                if (parser.parse_content("graph { a -- b [weight=-1] }",
+                                         &weighted) ||
+                    parser.parse_content("graph { a -- b [len=far] }",
+                                         &weighted)) {
+                        std::cout << "Test failed: Invalid weights should"
+                                  << " not be accepted." << std::endl;
+                        return TestFail;
+                }
+
+                /* a stream spanning several read blocks, with ';' and braces
+                 * in names and comments */
+                std::string stream_example = "graph stream {\n";
+                for (int index = 0 ; index < 20000 ; index++) {
+                        stream_example += "  \"v;" + std::to_string(index) +
+                                "{\" -- v" + std::to_string(index + 1) +
+                                "; /* ; } */\n";
+                }
+                stream_example += "}\n";
+                std::istringstream input(stream_example);
+                Graph streamed;
+                reset_objects();
+                if (!parser.parse_stream(input, &streamed) ||
+                    !parser.parse_content(stream_example, &graph)) {
+                        std::cout << "Test failed: Parse of the stream "
+                                  << "example was not successful."
+                                  << std::endl;
+                        return TestFail;
+                }
+                if (streamed.vertices() != 40000 ||
+                    streamed.vertices() != graph.vertices() ||
+                    streamed.vertex_name(20000) != "v;10000{" ||
+                    streamed.get_shortest_path("v;5{", "v6").size() != 2) {
+                        std::cout << "Test failed: Unexpected graph from the"
+                                  << " stream example." << std::endl;
+                        return TestFail;
+                }
+
+                /* attribute lists separate their attributes by ';' too, one
+                 * of them straddles the end of the first read block */
+                std::string bracketed = "graph bracketed {\n";
+                int last = 0;
+                while (bracketed.size() < 65500) {
+                        bracketed += "  b" + std::to_string(last) + " -- b" +
+                                std::to_string(last + 1) +
+                                " [weight=2; color=red]\n";
+                        last++;
+                }
+                bracketed += "  b" + std::to_string(last) + " -- b" +
+                        std::to_string(last + 1) + " [weight=2;";
+                bracketed += std::string(65540 - bracketed.size(), ' ');
+                bracketed += "color=red; len=2]\n}\n";
+                last++;
+                std::istringstream bracketed_input(bracketed);
+                Graph bracketed_graph;
+                reset_objects();
+                if (!parser.parse_stream(bracketed_input, &bracketed_graph) ||
+                    bracketed_graph.vertices() != last + 1 ||
+                    bracketed_graph.get_shortest_distance(
+                            "b0", "b" + std::to_string(last)) != 2 * last) {
+                        std::cout << "Test failed: Stream with attribute "
+                                  << "lists across a block" << std::endl;
+                        return TestFail;
+                }
+
+                /* large enough to be parsed in parallel pieces, vertex ids
+                 * have to match the ones of a sequential parse */
+                std::string large_example = "graph large {\n";
+                for (int index = 0 ; index < 80000 ; index++) {
+                        large_example += "  n" +
+                                std::to_string(index * 7919 % 30011) +
+                                " -- n" + std::to_string(index % 25013) +
+                                " [weight=1];\n";
+                }
+                large_example += "}\n";
+                Graph parallel;
+                reset_objects();
+                parser.set_threads(4);
+                bool parsed = parser.parse_content(large_example, &parallel);
+                parser.set_threads(1);
+                if (!parsed || !parser.parse_content(large_example, &graph)) {
+                        std::cout << "Test failed: Parse of the large "
+                                  << "example was not successful."
+                                  << std::endl;
+                        return TestFail;
+                }
+                if (parallel.vertices() != graph.vertices()) {
+                        std::cout << "Test failed: Parallel parse found "
+                                  << parallel.vertices() << " vertices "
+                                  << "instead of " << graph.vertices()
+                                  << std::endl;
+                        return TestFail;
+                }
+                for (int index = 0 ; index < graph.vertices() ; index++) {
+                        if (parallel.vertex_name(index) !=
+                            graph.vertex_name(index)) {
+                                std::cout << "Test failed: Parallel parse "
+                                          << "assigned a different id to "
+                                          << graph.vertex_name(index)
+                                          << std::endl;
+                                return TestFail;
+                        }
+                }
+                if (parallel.get_shortest_path("n0", "n30010") !=
+                    graph.get_shortest_path("n0", "n30010")) {
+                        std::cout << "Test failed: Unexpected path after "
+                                  << "the parallel parse." << std::endl;
+                        return TestFail;
+                }
+
+                /* the pieces are cut outside of attribute lists, which
+                 * separate their attributes by ';' as well */
+                std::string attributed = "graph attributed {\n";
+                for (int index = 0 ; index < 40000 ; index++) {
+                        attributed += "  a" + std::to_string(index) +
+                                " -- a" + std::to_string(index + 1) +
+                                " [color=red; style=bold; weight=2; "
+                                "label=\"edge\"; fontsize=10; len=2];\n";
+                }
+                attributed += "}\n";
+                Graph attributed_parallel;
+                reset_objects();
+                parser.set_threads(4);
+                parsed = parser.parse_content(attributed,
+                                              &attributed_parallel);
+                int pieces = parser.parallel_pieces();
+                parser.set_threads(1);
+                if (!parsed || pieces < 2 ||
+                    attributed_parallel.vertices() != 40001 ||
+                    attributed_parallel.vertex_index("a20000") != 20000 ||
+                    attributed_parallel.get_shortest_distance(
+                            "a0", "a40000") != 80000) {
+                        std::cout << "Test failed: Parallel parse of "
+                                  << "attribute lists in " << pieces
+                                  << " pieces" << std::endl;
+                        return TestFail;
+                }
+
+                /* a default weight set in the middle of a large input
+                 * applies to all following pieces */
+                std::string chain_example = "graph chain {\n";
+                for (int index = 0 ; index < 80000 ; index++) {
+                        if (index == 40000)
+                                chain_example += "  edge [weight=2];\n";
+                        chain_example += "  n" + std::to_string(index) +
+                                " -- n" + std::to_string(index + 1) + ";\n";
+                }
+                chain_example += "}\n";
+                Graph chain;
+                parser.set_threads(4);
+                parsed = parser.parse_content(chain_example, &chain);
+                parser.set_threads(1);
+                if (!parsed ||
+                    chain.get_shortest_distance("n0", "n80000") != 120000) {
+                        std::cout << "Test failed: Unexpected weights after "
+                                  << "the parallel parse." << std::endl;
+                        return TestFail;
+                }
+
+                large_example.insert(large_example.size() / 2, " -- ;");
+                reset_objects();
+                parser.set_threads(4);
+                if (parser.parse_content(large_example, &graph)) {
+                        std::cout << "Test failed: Parallel parse of an "
+                                  << "invalid graph should not succeed."
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                std::istringstream truncated("graph t {\n a -- b;\n");
+                reset_objects();
+                if (parser.parse_stream(truncated, &graph)) {
+                        std::cout << "Test failed: Parse of a stream without"
+                                  << " '}' should not succeed." << std::endl;
+                        return TestFail;
+                }
+
                 return TestPass;
         }
 
@@ -1,4 +1,12 @@
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
 #include <tuple>
+#include <vector>
+#include "graph.h"
+#include "output_sink.h"
 #include "print_coordinates.h"
 #include "test.h"
 
@@ -13,6 +21,269 @@ protected:
                     std::make_tuple(1, 2, 0),
                     std::make_tuple(1, 3, 0)) == false)
                         return TestFail;
+
+                /* the printer reads the graph through a view, an arc of a
+                 * directed graph is drawn like an undirected edge */
+                Graph graph;
+                for (auto& name : {"a", "b", "c", "d"}) {
+                        graph.create_vertex(name);
+                }
+                graph.link_two_vertices_directed(3, 0);
+                graph.link_two_vertices_directed(1, 0);
+                graph.link_two_vertices_directed(1, 3);
+                std::string drawing;
+                {
+                        StringSink sink(drawing);
+                        PrintCoordinates printer(graph.view());
+                        printer.print(sink);
+                }
+                std::string expected =
+                        "a----b    c    d\n"
+                        "|    |         |\n"
+                        "|    O---------O\n"
+                        "|              |\n"
+                        "O--------------O\n";
+                if (drawing != expected) {
+                        std::cout << "Test failed: drawing" << std::endl
+                                  << drawing;
+                        return TestFail;
+                }
+
+                /* the neighborhood keeps the order of the vertices, b and d
+                 * are neighbors without c */
+                std::string neighborhood;
+                {
+                        StringSink sink(neighborhood);
+                        graph.print_neighborhood(sink, "d", 1);
+                        graph.print_neighborhood(sink, "c", 3);
+                }
+                if (neighborhood != "a----b----d\n"
+                                    "|         |\n"
+                                    "O---------O\n"
+                                    "c\n") {
+                        std::cout << "Test failed: neighborhood" << std::endl
+                                  << neighborhood;
+                        return TestFail;
+                }
+                {
+                        StringSink sink(drawing);
+                        if (graph.print_neighborhood(sink, "x", 1) ||
+                            graph.print_neighborhood(sink, "a", -1)) {
+                                std::cout << "Test failed: neighborhood of "
+                                          << "a missing vertex" << std::endl;
+                                return TestFail;
+                        }
+                }
+                if (run_viewports() != TestPass || run_layouts() != TestPass)
+                        return TestFail;
+
+                /* a sink hands its buffer on once it is full */
+                std::string pieces;
+                int calls = 0;
+                {
+                        CallbackSink sink([&](const char* text,
+                                              std::size_t length) {
+                                pieces.append(text, length);
+                                calls++;
+                        }, 8);
+                        sink.write("0123456");
+                        sink.fill('-', 5);
+                        sink.write("a long line of text");
+                        sink.put('\n');
+                }
+                if (pieces != "0123456-----a long line of text\n" ||
+                    calls != 4) {
+                        std::cout << "Test failed: callback sink, " << calls
+                                  << " calls" << std::endl;
+                        return TestFail;
+                }
+                return TestPass;
+        }
+
+        /* every line of a window is the same part of the line of the full
+         * drawing */
+        int run_viewports()
+        {
+                Graph graph;
+                const int count = 40;
+                for (int index = 0 ; index < count ; index++) {
+                        graph.create_vertex("v" + std::to_string(index));
+                }
+                for (int index = 0 ; index < count ; index++) {
+                        graph.link_two_vertices_undirected(
+                                index, (index * 7 + 3) % count);
+                        if (index % 3 == 0)
+                                graph.link_two_vertices_directed(
+                                        index, (index + 1) % count);
+                }
+                std::string full;
+                {
+                        StringSink sink(full);
+                        graph.print_graph(sink);
+                }
+                std::vector<std::string> lines;
+                std::istringstream stream(full);
+                for (std::string line ; std::getline(stream, line) ; ) {
+                        lines.push_back(line);
+                }
+                int width = static_cast<int>(lines[1].size() - 1) /
+                        (count - 1);
+                int rows = static_cast<int>(lines.size()) - 1;
+
+                Viewport viewports[] = {
+                        { 0, count, 0, rows },
+                        { 0, 5, 0, 10 },
+                        { 17, 9, 31, 12 },
+                        { 35, 10, rows - 4, 10 },
+                        { -3, 4, -2, 3 },
+                        { count, 3, 0, 3 },
+                };
+                for (auto& viewport : viewports) {
+                        std::string window;
+                        {
+                                StringSink sink(window);
+                                graph.print_graph(sink, viewport);
+                        }
+                        int first = std::max(viewport.first_column, 0);
+                        int columns = std::min(count,
+                                               viewport.first_column +
+                                               viewport.columns) - first;
+                        int first_row = std::max(viewport.first_row, 0);
+                        int last_row = viewport.first_row + viewport.rows;
+                        std::string expected;
+                        for (int line = 0 ; columns > 0 &&
+                             line < rows + 1 ; line++) {
+                                if (line > 0 && (line - 1 < first_row ||
+                                                 line - 1 >= last_row))
+                                        continue;
+                                std::size_t start = first * width;
+                                if (start < lines[line].size())
+                                        expected += lines[line].substr(
+                                                start, columns * width);
+                                expected += '\n';
+                        }
+                        if (window != expected) {
+                                std::cout << "Test failed: viewport at "
+                                          << viewport.first_column << ", "
+                                          << viewport.first_row << std::endl
+                                          << window;
+                                return TestFail;
+                        }
+                }
+                return TestPass;
+        }
+
+        /* the edges read off a drawing with columns `width` wide, as pairs
+         * of names */
+        std::set< std::pair<std::string, std::string> > read_edges(
+                const std::string& drawing, int width)
+        {
+                std::set< std::pair<std::string, std::string> > edges;
+                std::vector<std::string> lines;
+                std::istringstream stream(drawing);
+                for (std::string line ; std::getline(stream, line) ; ) {
+                        lines.push_back(line);
+                }
+                std::vector<std::string> names;
+                const std::string& head = lines[0];
+                for (std::size_t start = 0 ; start < head.size() ;
+                     start += width) {
+                        std::size_t end = head.find_first_of("- ", start);
+                        names.push_back(head.substr(start, end - start));
+                        if (end < head.size() && head[end] == '-')
+                                edges.insert(std::make_pair(
+                                        names.back(),
+                                        head.substr(start + width,
+                                                    head.find_first_of(
+                                                            "- ",
+                                                            start + width) -
+                                                    start - width)));
+                }
+                for (std::size_t row = 2 ; row < lines.size() ; row += 2) {
+                        int open = -1;
+                        const std::string& line = lines[row];
+                        for (std::size_t col = 0 ; col < names.size() ;
+                             col++) {
+                                std::size_t at = col * width;
+                                if (at >= line.size() || line[at] != 'O')
+                                        continue;
+                                if (open < 0) {
+                                        open = static_cast<int>(col);
+                                        continue;
+                                }
+                                edges.insert(std::make_pair(names[open],
+                                                            names[col]));
+                                open = -1;
+                        }
+                }
+                return edges;
+        }
+
+        /* a compact layout draws the same edges in fewer rows */
+        int run_layouts()
+        {
+                Graph graph;
+                const int count = 60;
+                std::set< std::pair<std::string, std::string> > expected;
+                for (int index = 0 ; index < count ; index++) {
+                        graph.create_vertex("v" + std::to_string(index));
+                }
+                for (int index = 0 ; index < count ; index++) {
+                        for (int adj : {(index * 7 + 3) % count,
+                                        (index + 13) % count}) {
+                                graph.link_two_vertices_undirected(index,
+                                                                   adj);
+                        }
+                }
+                std::vector<std::string> drawings;
+                Layout layouts[] = {
+                        { false, false }, { true, false },
+                        { false, true }, { true, true },
+                };
+                for (auto& layout : layouts) {
+                        std::string drawing;
+                        {
+                                StringSink sink(drawing);
+                                PrintCoordinates printer(graph.view(),
+                                                         layout);
+                                printer.print(sink);
+                        }
+                        drawings.push_back(drawing);
+                }
+                GraphView view = graph.view();
+                for (int index = 0 ; index < count ; index++) {
+                        for (int adj : view.neighbors(index)) {
+                                std::string one = graph.vertex_name(index);
+                                std::string two = graph.vertex_name(adj);
+                                expected.insert(std::make_pair(one, two));
+                                expected.insert(std::make_pair(two, one));
+                        }
+                }
+                for (std::size_t index = 0 ; index < drawings.size() ;
+                     index++) {
+                        auto edges = read_edges(drawings[index], 7);
+                        for (auto& edge : edges) {
+                                if (expected.count(edge))
+                                        continue;
+                                std::cout << "Test failed: layout " << index
+                                          << " draws " << edge.first << "-"
+                                          << edge.second << std::endl;
+                                return TestFail;
+                        }
+                        if (edges.size() * 2 != expected.size()) {
+                                std::cout << "Test failed: layout " << index
+                                          << " draws " << edges.size()
+                                          << " edges" << std::endl;
+                                return TestFail;
+                        }
+                }
+                if (drawings[3].size() >= drawings[2].size() ||
+                    drawings[2].size() >= drawings[0].size() ||
+                    drawings[1].size() >= drawings[0].size()) {
+                        std::cout << "Test failed: compact layout"
+                                  << std::endl;
+                        return TestFail;
+                }
                 return TestPass;
         }
 };
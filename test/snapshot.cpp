@@ -0,0 +1,225 @@
+#include <unistd.h>
+#include <stdlib.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "graph.h"
+#include "snapshot.h"
+#include "test.h"
+
+using namespace ascii_graph;
+
+class SnapshotTest : public Test
+{
+protected:
+        int init()
+        {
+                path = "/tmp/ascii_graph.snapshot.XXXXXX";
+                int fd = mkstemp(&path.front());
+                if (fd < 0) {
+                        std::cout << "Test failed: creation of temp."
+                                  << " file failed, fd = " << fd
+                                  << std::endl;
+                        return TestFail;
+                }
+                close(fd);
+
+                /* a ring of named vertices with a few chords */
+                for (int index = 0 ; index < 500 ; index++) {
+                        graph.create_vertex("host-" + std::to_string(index));
+                }
+                for (int index = 0 ; index < 500 ; index++) {
+                        graph.link_two_vertices_undirected(index,
+                                                           (index + 1) % 500);
+                        if (index % 50 == 0)
+                                graph.link_two_vertices_undirected(
+                                        index, (index + 250) % 500);
+                }
+                return TestPass;
+        }
+
+        int run()
+        {
+                if (!graph.save_snapshot(path)) {
+                        std::cout << "Test failed: saving the snapshot"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                Graph loaded;
+                if (!loaded.load_snapshot(path)) {
+                        std::cout << "Test failed: loading the snapshot"
+                                  << std::endl;
+                        return TestFail;
+                }
+                if (loaded.vertices() != 500 ||
+                    loaded.vertex_name(123) != "host-123" ||
+                    loaded.vertex_index("host-499") != 499 ||
+                    loaded.get_shortest_path("host-10", "host-260") !=
+                    graph.get_shortest_path("host-10", "host-260")) {
+                        std::cout << "Test failed: the loaded graph differs"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* modifying a loaded graph copies it out of the mapping */
+                int vertex = loaded.create_vertex("host-new");
+                loaded.link_two_vertices_undirected(vertex, 0);
+                if (vertex != 500 ||
+                    loaded.get_shortest_path("host-new", "host-1").size() !=
+                    3) {
+                        std::cout << "Test failed: modification of a loaded"
+                                  << " graph" << std::endl;
+                        return TestFail;
+                }
+
+                Graph dense;
+                dense.set_storage(StorageMode::BitMatrix);
+                if (!dense.load_snapshot(path) ||
+                    dense.get_shortest_path("host-10", "host-260") !=
+                    graph.get_shortest_path("host-10", "host-260")) {
+                        std::cout << "Test failed: loading the snapshot as"
+                                  << " a bit matrix" << std::endl;
+                        return TestFail;
+                }
+
+                Graph one_way;
+                one_way.create_vertex("from");
+                one_way.create_vertex("to");
+                one_way.link_two_vertices_directed(0, 1);
+                Graph one_way_loaded;
+                if (!one_way.save_snapshot(path) ||
+                    !one_way_loaded.load_snapshot(path) ||
+                    !one_way_loaded.directed() ||
+                    one_way_loaded.get_shortest_path(
+                            "from", "to",
+                            PathAlgorithm::BidirectionalBfs).size() != 2 ||
+                    !one_way_loaded.get_shortest_path("to", "from").empty()) {
+                        std::cout << "Test failed: directed snapshot"
+                                  << std::endl;
+                        return TestFail;
+                }
+                Graph roads;
+                roads.create_vertex("s");
+                roads.create_vertex("a");
+                roads.create_vertex("t");
+                roads.link_two_vertices_undirected(0, 2, 5);
+                roads.link_two_vertices_undirected(0, 1, 1);
+                roads.link_two_vertices_directed(1, 2, 0.25);
+                Graph roads_loaded;
+                Graph roads_dense;
+                roads_dense.set_storage(StorageMode::BitMatrix);
+                if (!roads.save_snapshot(path) ||
+                    !roads_loaded.load_snapshot(path) ||
+                    !roads_dense.load_snapshot(path) ||
+                    !roads_loaded.weighted() ||
+                    roads_loaded.get_shortest_distance("s", "t") != 1.25 ||
+                    roads_loaded.get_shortest_distance("t", "s") != 5 ||
+                    roads_dense.get_shortest_distance("s", "t") != 1.25) {
+                        std::cout << "Test failed: weighted snapshot"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* the landmark index is stored with the graph */
+                Graph guided;
+                if (!roads.build_landmarks() || !roads.save_snapshot(path) ||
+                    !guided.load_snapshot(path) || !guided.has_landmarks() ||
+                    guided.get_shortest_distance(
+                            "s", "t", PathAlgorithm::Landmarks) != 1.25 ||
+                    guided.get_shortest_distance(
+                            "t", "a", PathAlgorithm::Landmarks) != 6) {
+                        std::cout << "Test failed: snapshot with landmarks"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* the removed vertices of the replaced graph are gone */
+                Graph pruned;
+                for (auto& name : {"p", "q", "r"}) {
+                        pruned.create_vertex(name);
+                }
+                pruned.link_two_vertices_undirected(0, 1);
+                pruned.link_two_vertices_undirected(1, 2);
+                std::string edges;
+                StringSink sink(edges);
+                if (pruned.remove_vertex(1) != 0 ||
+                    !pruned.load_snapshot(path) ||
+                    pruned.removed(1) || pruned.removed_vertices() != 0 ||
+                    pruned.empty() || pruned.vertex_index("a") != 1 ||
+                    pruned.get_shortest_distance("s", "a") != 1) {
+                        std::cout << "Test failed: snapshot loaded over"
+                                  << " removed vertices" << std::endl;
+                        return TestFail;
+                }
+                pruned.print_matrix(sink, MatrixFormat::EdgeList);
+                sink.flush();
+                if (edges != "s a 1\ns t 5\na s 1\na t 0.25\nt s 5\n") {
+                        std::cout << "Test failed: edges of a snapshot loaded"
+                                  << " over removed vertices" << std::endl
+                                  << edges;
+                        return TestFail;
+                }
+
+                /* rows out of order or with duplicates are rejected even
+                 * with valid checksums */
+                SymbolTable names;
+                for (auto& name : {"u", "v", "w"}) {
+                        names.intern(name);
+                }
+                const int offsets[] = {0, 2, 3, 4};
+                const int unsorted[] = {2, 1, 0, 0};
+                const int repeated[] = {1, 1, 0, 0};
+                for (const int* targets : {unsorted, repeated}) {
+                        CsrGraph rows;
+                        rows.attach(offsets, targets, nullptr, 3);
+                        Snapshot written;
+                        if (!Snapshot::write(path, names, rows, nullptr) ||
+                            written.open(path)) {
+                                std::cout << "Test failed: a snapshot with "
+                                          << "unsorted rows was loaded"
+                                          << std::endl;
+                                return TestFail;
+                        }
+                }
+
+                if (!graph.save_snapshot(path)) {
+                        std::cout << "Test failed: saving the snapshot"
+                                  << std::endl;
+                        return TestFail;
+                }
+
+                /* flip a bit in the target section */
+                std::fstream file(path, std::ios::in | std::ios::out |
+                                  std::ios::binary);
+                file.seekg(0, std::ios::end);
+                std::streamoff size = file.tellg();
+                file.seekp(size - 16);
+                file.put('\x7f');
+                file.close();
+                Graph corrupted;
+                if (corrupted.load_snapshot(path)) {
+                        std::cout << "Test failed: a corrupted snapshot was"
+                                  << " loaded" << std::endl;
+                        return TestFail;
+                }
+
+                if (truncate(path.c_str(), 100) != 0 ||
+                    corrupted.load_snapshot(path)) {
+                        std::cout << "Test failed: a truncated snapshot was"
+                                  << " loaded" << std::endl;
+                        return TestFail;
+                }
+                return TestPass;
+        }
+
+        void cleanup()
+        {
+                unlink(path.c_str());
+        }
+private:
+        Graph graph;
+        std::string path;
+};
+
+TEST_REGISTER(SnapshotTest)
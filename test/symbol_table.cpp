@@ -0,0 +1,48 @@
+#include <iostream>
+#include <string>
+#include "symbol_table.h"
+#include "test.h"
+
+using namespace ascii_graph;
+
+class SymbolTableTest : public Test
+{
+protected:
+        int run()
+        {
+                /* enough names to grow the hash index a few times */
+                for (int id = 0 ; id < 1000 ; id++) {
+                        std::string name = "service-" + std::to_string(id);
+                        if (symbols.intern(name) != id) {
+                                std::cout << "Test failed: " << name
+                                          << " didn't get id " << id
+                                          << std::endl;
+                                return TestFail;
+                        }
+                }
+                if (symbols.intern("service-42") != 42 ||
+                    symbols.size() != 1000) {
+                        std::cout << "Test failed: interning a known name "
+                                  << "added a new id" << std::endl;
+                        return TestFail;
+                }
+                if (symbols.find("service-999") != 999 ||
+                    symbols.find("service-1000") != -1 ||
+                    symbols.find("") != -1) {
+                        std::cout << "Test failed: lookup of names"
+                                  << std::endl;
+                        return TestFail;
+                }
+                if (symbols.name(123) != "service-123" ||
+                    symbols.length(7) != 9) {
+                        std::cout << "Test failed: name of id 123 is "
+                                  << symbols.name(123) << std::endl;
+                        return TestFail;
+                }
+                return TestPass;
+        }
+private:
+        SymbolTable symbols;
+};
+
+TEST_REGISTER(SymbolTableTest)
@@ -0,0 +1,251 @@
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <random>
+#include "dijkstra.h"
+#include "delta_stepping.h"
+#include "landmarks.h"
+#include "csr.h"
+#include "test.h"
+
+using namespace ascii_graph;
+
+class WeightedTest : public Test
+{
+protected:
+        int init()
+        {
+                /* random sparse graph with integer weights, so that the sums
+                 * are exact, a few vertices stay isolated */
+                std::mt19937 random(7);
+                std::uniform_int_distribution<int> pick(0, vertices - 1);
+                std::uniform_int_distribution<int> weight(0, 20);
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        builder.add_vertex();
+                }
+                for (int arc = 0 ; arc < 4 * vertices ; arc++) {
+                        int from = pick(random);
+                        int to = pick(random);
+                        if (from % 89 == 0 || to % 89 == 0)
+                                continue;
+                        builder.add_arc(from, to, weight(random));
+                }
+                /* a duplicate arc keeps the lower weight */
+                builder.add_arc(1, 2, 50);
+                builder.add_arc(1, 2, 0.5);
+                csr.freeze(builder);
+                reverse.transpose(csr);
+                return TestPass;
+        }
+
+        /* lazy deletion priority queue as reference */
+        std::vector<double> reference_distances(int source)
+        {
+                typedef std::pair<double, int> Entry;
+                std::vector<double> distance(
+                        vertices, std::numeric_limits<double>::infinity());
+                std::priority_queue<Entry, std::vector<Entry>,
+                                    std::greater<Entry> > queue;
+                distance[source] = 0;
+                queue.push(Entry(0, source));
+                while (!queue.empty()) {
+                        Entry current = queue.top();
+                        queue.pop();
+                        if (current.first > distance[current.second])
+                                continue;
+                        csr.for_each_weighted(current.second,
+                                              [&](int adj, float weight) {
+                                double next = current.first + weight;
+                                if (next >= distance[adj])
+                                        return;
+                                distance[adj] = next;
+                                queue.push(Entry(next, adj));
+                        });
+                }
+                return distance;
+        }
+
+        /* the path has to exist and add up to the distance */
+        bool check_path(const std::vector<int>& path, int source, int goal,
+                        double distance)
+        {
+                if (path.empty() || path.front() != source ||
+                    path.back() != goal)
+                        return false;
+                double length = 0;
+                for (std::size_t index = 1 ; index < path.size() ; index++) {
+                        const int* adj = csr.begin(path[index - 1]);
+                        while (adj != csr.end(path[index - 1]) &&
+                               *adj != path[index]) {
+                                ++adj;
+                        }
+                        if (adj == csr.end(path[index - 1]))
+                                return false;
+                        length += csr.weight(adj);
+                }
+                return length == distance;
+        }
+
+        int run()
+        {
+                const int* arc = csr.begin(1);
+                while (*arc != 2) {
+                        ++arc;
+                }
+                if (!csr.weighted() || csr.weight(arc) != 0.5f) {
+                        std::cout << "Test failed: duplicate arc weighs "
+                                  << csr.weight(arc) << std::endl;
+                        return TestFail;
+                }
+
+                std::vector<double> distance = reference_distances(1);
+                Dijkstra dijkstra(csr);
+                dijkstra.run(1);
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        if (dijkstra.distance(vertex) != distance[vertex] ||
+                            (dijkstra.reached(vertex) &&
+                             !check_path(dijkstra.path(vertex), 1, vertex,
+                                         distance[vertex]))) {
+                                std::cout << "Test failed: Dijkstra distance"
+                                          << " to " << vertex << std::endl;
+                                return TestFail;
+                        }
+                }
+                if (dijkstra.reached(89) || !dijkstra.path(89).empty()) {
+                        std::cout << "Test failed: Dijkstra reached an "
+                                  << "isolated vertex" << std::endl;
+                        return TestFail;
+                }
+
+                /* every bucket width and thread count gives the same
+                 * distances, heavy arcs included */
+                for (int threads : {1, 3}) {
+                        for (double delta : {0.0, 1.0, 7.0, 100.0}) {
+                                DeltaStepping delta_stepping(csr, threads);
+                                delta_stepping.set_delta(delta);
+                                delta_stepping.run(1);
+                                for (int vertex = 0 ; vertex < vertices ;
+                                     vertex++) {
+                                        if (delta_stepping.distance(vertex) ==
+                                            distance[vertex] &&
+                                            (!delta_stepping.reached(vertex) ||
+                                             check_path(delta_stepping.path(
+                                                                vertex), 1,
+                                                        vertex,
+                                                        distance[vertex])))
+                                                continue;
+                                        std::cout << "Test failed: delta "
+                                                  << "stepping distance to "
+                                                  << vertex << " with delta "
+                                                  << delta << " on "
+                                                  << threads << " threads"
+                                                  << std::endl;
+                                        return TestFail;
+                                }
+                        }
+                }
+
+                /* a search for a goal stops early but gets it right */
+                DeltaStepping goal_search(csr, 2);
+                goal_search.run(1, 4321);
+                dijkstra.run(1, 4321);
+                if (goal_search.distance(4321) != distance[4321] ||
+                    dijkstra.distance(4321) != distance[4321]) {
+                        std::cout << "Test failed: distance of a goal"
+                                  << std::endl;
+                        return TestFail;
+                }
+                return run_landmarks(distance);
+        }
+
+        /* A* guided by landmarks finds the same distances with fewer
+         * settled vertices, `distance` is measured from vertex 1 */
+        int run_landmarks(const std::vector<double>& distance)
+        {
+                LandmarkIndex landmarks;
+                landmarks.build(csr, reverse, true, 8);
+                if (landmarks.count() != 8 || !landmarks.directed() ||
+                    landmarks.bound(1, 1) != 0) {
+                        std::cout << "Test failed: landmark index"
+                                  << std::endl;
+                        return TestFail;
+                }
+                Dijkstra plain(csr);
+                Dijkstra guided(csr);
+                long plain_settled = 0;
+                long guided_settled = 0;
+                for (int goal = 0 ; goal < vertices ; goal += 37) {
+                        plain.run(1, goal);
+                        guided.run(1, goal, &landmarks);
+                        plain_settled += plain.settled();
+                        guided_settled += guided.settled();
+                        if (guided.distance(goal) != distance[goal] ||
+                            landmarks.bound(1, goal) > distance[goal] ||
+                            (guided.reached(goal) &&
+                             !check_path(guided.path(goal), 1, goal,
+                                         distance[goal]))) {
+                                std::cout << "Test failed: guided distance "
+                                          << "to " << goal << std::endl;
+                                return TestFail;
+                        }
+                }
+                if (guided_settled >= plain_settled) {
+                        std::cout << "Test failed: the guided search settled "
+                                  << guided_settled << " vertices, the plain "
+                                  << "one " << plain_settled << std::endl;
+                        return TestFail;
+                }
+                return run_fractional_landmarks();
+        }
+
+        /* distances beyond the precision of the stored floats must not
+         * make the bounds exceed the true distances */
+        int run_fractional_landmarks()
+        {
+                std::mt19937 random(11);
+                std::uniform_int_distribution<int> pick(0, vertices - 1);
+                std::uniform_real_distribution<float> weight(0.1, 3e6);
+                CsrBuilder fractional_builder;
+                for (int vertex = 0 ; vertex < vertices ; vertex++) {
+                        fractional_builder.add_vertex();
+                }
+                for (int arc = 0 ; arc < 3 * vertices ; arc++) {
+                        fractional_builder.add_arc(pick(random), pick(random),
+                                                   weight(random));
+                }
+                CsrGraph fractional;
+                CsrGraph fractional_in;
+                fractional.freeze(fractional_builder);
+                fractional_in.transpose(fractional);
+                LandmarkIndex landmarks;
+                landmarks.build(fractional, fractional_in, true, 8);
+                Dijkstra plain(fractional);
+                Dijkstra guided(fractional);
+                for (int source = 0 ; source < vertices ; source += 499) {
+                        plain.run(source);
+                        for (int goal = 0 ; goal < vertices ; goal += 7) {
+                                if (!plain.reached(goal))
+                                        continue;
+                                guided.run(source, goal, &landmarks);
+                                if (landmarks.bound(source, goal) >
+                                    plain.distance(goal) ||
+                                    guided.distance(goal) !=
+                                    plain.distance(goal)) {
+                                        std::cout << "Test failed: fractional "
+                                                  << "guided distance from "
+                                                  << source << " to " << goal
+                                                  << std::endl;
+                                        return TestFail;
+                                }
+                        }
+                }
+                return TestPass;
+        }
+private:
+        static const int vertices = 5000;
+        CsrBuilder builder;
+        CsrGraph csr;
+        CsrGraph reverse;
+};
+
+TEST_REGISTER(WeightedTest)